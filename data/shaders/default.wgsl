@@ -1,8 +1,12 @@
-struct VertexInput {
+// One quad per instance, see QuadData
+struct QuadInput {
   @location(0) position: vec3f,
-  @location(1) uv: vec2f,
-  @location(2) texture_id: f32,
+  @location(1) size: vec2f,
+  // Top left and bottom right
+  @location(2) uv: vec4f,
   @location(3) color: vec4f,
+  // Texture slot, render face
+  @location(4) texture_face: vec4u,
 }
 
 struct VertexOutput {
@@ -22,13 +26,39 @@ struct Uniforms {
 
 @group(1) @binding(0) var textures: binding_array<texture_2d<f32>>;
 
+// Values of RenderFace
+const FACE_FRONT: u32 = 1u;
+const FACE_BOTTOM: u32 = 3u;
+const FACE_TOP_FRONT: u32 = 8u;
+
 @vertex
-fn vs_main(in: VertexInput) -> VertexOutput {
+fn vs_main(@builtin(vertex_index) vertex_index: u32, in: QuadInput) -> VertexOutput {
+  // Top left, top right, bottom left and bottom left, top right, bottom right
+  var corners = array<u32, 6>(0u, 1u, 2u, 2u, 1u, 3u);
+  let corner_index = corners[vertex_index];
+  let corner = vec2f(f32(corner_index & 1u), f32(corner_index >> 1u));
+
+  var offset = vec3f(corner * in.size, 0.0);
+
+  switch (in.texture_face.y) {
+    case FACE_FRONT: {
+      offset = vec3f(corner.x * in.size.x, in.size.y, -corner.y * in.size.y);
+    }
+    case FACE_BOTTOM: {
+      offset = vec3f(corner * in.size, -in.size.y);
+    }
+    case FACE_TOP_FRONT: {
+      offset = vec3f(corner.x * in.size.x, in.size.y, (1.0 - corner.y) * in.size.y);
+    }
+    default { }
+  }
+
   var out: VertexOutput;
-  out.position = uniforms.projection * uniforms.view * vec4f(in.position, 1.0);
+  out.position = uniforms.projection * uniforms.view * vec4f(in.position + offset, 1.0);
   out.color = in.color.abgr;
-  out.uv = in.uv;
-  out.texture_id = in.texture_id;
+  out.uv = mix(in.uv.xy, in.uv.zw, corner);
+  // Quads without texture use the slot 255 which falls in the default case of the fragment shader
+  out.texture_id = f32(in.texture_face.x);
   return out;
 }
 
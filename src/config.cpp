@@ -28,12 +28,21 @@ namespace world
 {
 std::string texture_id = "spritesheet-tileset";
 uint32_t spatial_hash_cell_size = 2;
+bool compact_chunks = true;
+bool stream_chunks = true;
+uint32_t chunks_added_per_frame = 2;
+double chunk_autosave_interval = 60.0;
+uint32_t noise_cache_size = 64;
+// Chunk meshes built in the background at the same time
+uint32_t chunk_meshing_jobs = 4;
 }  // namespace world
 
 namespace pathfinding
 {
 uint32_t max_steps = 700;
 uint32_t tries_after_collision = 3;
+double turn_budget_ms = 4.0;
+uint32_t worker_threads = 2;
 }  // namespace pathfinding
 
 namespace ai
@@ -51,6 +60,8 @@ namespace world_creation
 uint32_t world_width = 256;
 uint32_t world_height = 256;
 uint32_t world_depth = 256;
+// Chunks around the starting position generated when a world is created
+int pregeneration_radius = 2;
 }  // namespace world_creation
 
 void load(const std::filesystem::path& filepath)
@@ -86,6 +97,12 @@ void load(const std::filesystem::path& filepath)
 
     json::assign_if_contains<std::string>(world, "texture_id", world::texture_id);
     json::assign_if_contains<uint32_t>(world, "spatial_hash_cell_size", world::spatial_hash_cell_size);
+    json::assign_if_contains<bool>(world, "compact_chunks", world::compact_chunks);
+    json::assign_if_contains<bool>(world, "stream_chunks", world::stream_chunks);
+    json::assign_if_contains<uint32_t>(world, "chunks_added_per_frame", world::chunks_added_per_frame);
+    json::assign_if_contains<double>(world, "chunk_autosave_interval", world::chunk_autosave_interval);
+    json::assign_if_contains<uint32_t>(world, "noise_cache_size", world::noise_cache_size);
+    json::assign_if_contains<uint32_t>(world, "chunk_meshing_jobs", world::chunk_meshing_jobs);
   }
 
   if (json.object.contains("display"))
@@ -103,6 +120,8 @@ void load(const std::filesystem::path& filepath)
 
     json::assign_if_contains<uint32_t>(pathfinding, "max_steps", pathfinding::max_steps);
     json::assign_if_contains<uint32_t>(pathfinding, "tries_after_collision", pathfinding::tries_after_collision);
+    json::assign_if_contains<double>(pathfinding, "turn_budget_ms", pathfinding::turn_budget_ms);
+    json::assign_if_contains<uint32_t>(pathfinding, "worker_threads", pathfinding::worker_threads);
   }
 
   if (json.object.contains("ai"))
@@ -126,6 +145,7 @@ void load(const std::filesystem::path& filepath)
     json::assign_if_contains<uint32_t>(world_creation, "world_width", world_creation::world_width);
     json::assign_if_contains<uint32_t>(world_creation, "world_height", world_creation::world_height);
     json::assign_if_contains<uint32_t>(world_creation, "world_depth", world_creation::world_depth);
+    json::assign_if_contains<int>(world_creation, "pregeneration_radius", world_creation::pregeneration_radius);
   }
 }
 }  // namespace dl::config
@@ -30,12 +30,20 @@ namespace world
 {
 extern std::string texture_id;
 extern uint32_t spatial_hash_cell_size;
+extern bool compact_chunks;
+extern bool stream_chunks;
+extern uint32_t chunks_added_per_frame;
+extern double chunk_autosave_interval;
+extern uint32_t noise_cache_size;
+extern uint32_t chunk_meshing_jobs;
 }  // namespace world
 
 namespace pathfinding
 {
 extern uint32_t max_steps;
 extern uint32_t tries_after_collision;
+extern double turn_budget_ms;
+extern uint32_t worker_threads;
 }  // namespace pathfinding
 
 namespace ai
@@ -53,6 +61,7 @@ namespace world_creation
 extern uint32_t world_width;
 extern uint32_t world_height;
 extern uint32_t world_depth;
+extern int pregeneration_radius;
 }  // namespace world_creation
 
 void load(const std::filesystem::path& filepath = "data/config.json");
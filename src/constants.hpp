@@ -15,6 +15,7 @@ namespace dl::directory
 static const std::filesystem::path data{"dl_data"};
 static const std::filesystem::path worlds{data / "worlds"};
 static const std::filesystem::path chunks{"chunks"};
+static const std::filesystem::path regions{"regions"};
 }  // namespace dl::directory
 
 namespace dl::filename
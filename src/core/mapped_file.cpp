@@ -0,0 +1,108 @@
+#include "./mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+namespace dl
+{
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& filepath)
+{
+  m_file_handle = CreateFileA(
+      filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if (m_file_handle == INVALID_HANDLE_VALUE)
+  {
+    m_file_handle = nullptr;
+    spdlog::warn("Could not open file for mapping: {}", filepath);
+    return;
+  }
+
+  LARGE_INTEGER file_size{};
+
+  if (!GetFileSizeEx(m_file_handle, &file_size) || file_size.QuadPart == 0)
+  {
+    return;
+  }
+
+  m_mapping_handle = CreateFileMappingA(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  if (m_mapping_handle == nullptr)
+  {
+    spdlog::warn("Could not map file: {}", filepath);
+    return;
+  }
+
+  m_data = static_cast<const char*>(MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+  m_size = m_data != nullptr ? static_cast<std::size_t>(file_size.QuadPart) : 0;
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data != nullptr)
+  {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping_handle != nullptr)
+  {
+    CloseHandle(m_mapping_handle);
+  }
+  if (m_file_handle != nullptr)
+  {
+    CloseHandle(m_file_handle);
+  }
+}
+#else
+MappedFile::MappedFile(const std::string& filepath)
+{
+  m_file_descriptor = open(filepath.c_str(), O_RDONLY);
+
+  if (m_file_descriptor < 0)
+  {
+    spdlog::warn("Could not open file for mapping: {}", filepath);
+    return;
+  }
+
+  struct stat file_stat
+  {
+  };
+
+  if (fstat(m_file_descriptor, &file_stat) != 0 || file_stat.st_size == 0)
+  {
+    return;
+  }
+
+  void* data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, m_file_descriptor, 0);
+
+  if (data == MAP_FAILED)
+  {
+    spdlog::warn("Could not map file: {}", filepath);
+    return;
+  }
+
+  m_data = static_cast<const char*>(data);
+  m_size = static_cast<std::size_t>(file_stat.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_data != nullptr)
+  {
+    munmap(const_cast<char*>(m_data), m_size);
+  }
+  if (m_file_descriptor >= 0)
+  {
+    close(m_file_descriptor);
+  }
+}
+#endif
+}  // namespace dl
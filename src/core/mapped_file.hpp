@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace dl
+{
+// Read only memory mapping of a whole file. Pages are only loaded from disk
+// when they are accessed, so parts of the file that aren't read cost nothing.
+class MappedFile
+{
+ public:
+  MappedFile(const std::string& filepath);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool is_open() const { return m_data != nullptr; }
+  const char* data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+
+ private:
+  const char* m_data = nullptr;
+  std::size_t m_size = 0;
+
+#ifdef _WIN32
+  void* m_file_handle = nullptr;
+  void* m_mapping_handle = nullptr;
+#else
+  int m_file_descriptor = -1;
+#endif
+};
+}  // namespace dl
@@ -2,18 +2,77 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cstdint>
 #include <limits>
 #include <random>
 
+#include "core/maths/vector.hpp"
+
 namespace dl::random
 {
-static std::random_device device;
-static std::mt19937 rng{device()};
-static std::uniform_real_distribution<double> real_distribution{0.f, 1.f};
-static std::uniform_int_distribution<int> int_distribution{1, std::numeric_limits<int>::max()};
+// SplitMix64 finalizer
+inline uint64_t mix(uint64_t value)
+{
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+  return value ^ (value >> 31);
+}
+
+// Key of a random stream that only depends on a seed and a position, e.g. a chunk position
+inline uint64_t make_key(const int seed, const Vector3i& position = Vector3i{0, 0, 0})
+{
+  uint64_t key = mix(static_cast<uint32_t>(seed));
+  key = mix(key ^ static_cast<uint32_t>(position.x));
+  key = mix(key ^ static_cast<uint32_t>(position.y));
+  return mix(key ^ static_cast<uint32_t>(position.z));
+}
+
+// Counter based generator, the nth value of a stream is a hash of its key and n so
+// the values don't depend on anything that was generated before in other streams
+class CounterEngine
+{
+ public:
+  using result_type = uint64_t;
+
+  CounterEngine(const uint64_t key = 0) { seed(key); }
+
+  static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  void seed(const uint64_t key)
+  {
+    m_key = mix(key);
+    m_counter = 0;
+  }
+
+  result_type operator()() { return mix(m_key + ++m_counter * 0x9e3779b97f4a7c15); }
+
+ private:
+  uint64_t m_key = 0;
+  uint64_t m_counter = 0;
+};
+
+// Each thread draws from its own stream
+inline thread_local CounterEngine rng{std::random_device{}()};
+
+// Makes the random helpers of the current thread draw from the stream of a key until
+// it goes out of scope, generating the same content regardless of thread or order
+class ScopedSeed
+{
+ public:
+  ScopedSeed(const uint64_t key) : m_previous(rng) { rng.seed(key); }
+  ~ScopedSeed() { rng = m_previous; }
+
+  ScopedSeed(const ScopedSeed&) = delete;
+  ScopedSeed& operator=(const ScopedSeed&) = delete;
+
+ private:
+  CounterEngine m_previous;
+};
 
 static inline double get_real()
 {
+  std::uniform_real_distribution<double> real_distribution{0.f, 1.f};
   return real_distribution(rng);
 }
 
@@ -21,6 +80,7 @@ static inline int get_integer(const int from = 0, const int to = 100)
 {
   assert(from < to && "From must be less than to");
 
+  std::uniform_int_distribution<int> int_distribution{1, std::numeric_limits<int>::max()};
   return int_distribution(rng) % (to - from) + from;
 }
 
@@ -0,0 +1,123 @@
+#include "./parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "./thread_pool.hpp"
+
+namespace
+{
+int get_hardware_thread_count()
+{
+  return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Workers shared by all the parallel calls, the calling thread also takes part in each call
+class Workers
+{
+ public:
+  dl::ThreadPool thread_pool{};
+
+  Workers() { thread_pool.initialize(std::max(1, get_hardware_thread_count() - 1)); }
+  ~Workers() { thread_pool.finalize(); }
+};
+
+dl::ThreadPool& get_thread_pool()
+{
+  static Workers workers{};
+  return workers.thread_pool;
+}
+
+// Items claimed by the calling thread and the workers. The workers own a reference since
+// they may only start after all the items were processed and the call returned.
+struct SharedWork
+{
+  std::atomic<int> next_item = 0;
+  int item_count = 0;
+  int processed_count = 0;
+  std::mutex mutex{};
+  std::condition_variable finished{};
+};
+
+// Calls function(item) for every item in [0, item_count) from the calling thread and up to
+// helper_count workers. The calling thread can process all the items by itself, so nested
+// calls from inside of a worker don't wait for workers that are busy.
+void run_items(const int item_count, const int helper_count, const std::function<void(const int)>& function)
+{
+  auto work = std::make_shared<SharedWork>();
+  work->item_count = item_count;
+
+  // The function is only called for claimed items, which the calling thread waits for
+  const auto process_items = [work, &function]()
+  {
+    int processed_count = 0;
+
+    for (int item = work->next_item++; item < work->item_count; item = work->next_item++)
+    {
+      function(item);
+      ++processed_count;
+    }
+
+    if (processed_count > 0)
+    {
+      const std::unique_lock<std::mutex> lock(work->mutex);
+      work->processed_count += processed_count;
+
+      if (work->processed_count == work->item_count)
+      {
+        work->finished.notify_all();
+      }
+    }
+  };
+
+  auto& thread_pool = get_thread_pool();
+
+  for (int i = 0; i < helper_count; ++i)
+  {
+    thread_pool.queue_job(process_items);
+  }
+
+  process_items();
+
+  std::unique_lock<std::mutex> lock(work->mutex);
+  work->finished.wait(lock, [&work] { return work->processed_count == work->item_count; });
+}
+}  // namespace
+
+namespace dl::parallel
+{
+void invoke(const std::vector<std::function<void()>>& tasks)
+{
+  if (tasks.empty())
+  {
+    return;
+  }
+
+  const int task_count = static_cast<int>(tasks.size());
+
+  run_items(task_count, task_count - 1, [&tasks](const int task) { tasks[task](); });
+}
+
+void for_each_range(const int count, const int range_size, const std::function<void(const int, const int)>& function)
+{
+  if (count <= 0)
+  {
+    return;
+  }
+
+  const int range_count = (count + range_size - 1) / range_size;
+  const int helper_count = std::min(range_count, get_hardware_thread_count()) - 1;
+
+  run_items(range_count,
+            helper_count,
+            [&function, range_size, count](const int range)
+            {
+              const int begin = range * range_size;
+              function(begin, std::min(begin + range_size, count));
+            });
+}
+}  // namespace dl::parallel
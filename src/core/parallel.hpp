@@ -0,0 +1,14 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace dl::parallel
+{
+// Runs the tasks concurrently and returns once all of them have finished
+void invoke(const std::vector<std::function<void()>>& tasks);
+
+// Splits [0, count) into ranges of range_size elements and calls function(begin, end)
+// for each range from several threads. The ranges must not depend on each other.
+void for_each_range(const int count, const int range_size, const std::function<void(const int, const int)>& function);
+}  // namespace dl::parallel
@@ -0,0 +1,302 @@
+#include "./region_file.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+#include "constants.hpp"
+
+namespace dl
+{
+namespace
+{
+constexpr uint32_t region_magic_number = 0x5240;
+constexpr std::size_t entry_size = sizeof(uint32_t) * 2;
+constexpr std::size_t header_size = sizeof(uint32_t) + entry_size * RegionFile::chunk_count;
+// Overwritten data is only reclaimed after it reaches this size
+constexpr std::size_t min_compact_size = 4 * 1024 * 1024;
+
+int floor_div(const int value, const int divisor)
+{
+  return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+}  // namespace
+
+RegionFile::RegionFile(const std::filesystem::path& filepath) : m_filepath(filepath) { m_load_header(); }
+
+Vector3i RegionFile::get_region_position(const Vector3i& chunk_position)
+{
+  return Vector3i{floor_div(chunk_position.x, world::chunk_size.x * region_size),
+                  floor_div(chunk_position.y, world::chunk_size.y * region_size),
+                  floor_div(chunk_position.z, world::chunk_size.z)};
+}
+
+int RegionFile::get_chunk_index(const Vector3i& chunk_position)
+{
+  const int x = floor_div(chunk_position.x, world::chunk_size.x);
+  const int y = floor_div(chunk_position.y, world::chunk_size.y);
+  return (x - floor_div(x, region_size) * region_size) + (y - floor_div(y, region_size) * region_size) * region_size;
+}
+
+bool RegionFile::contains(const int index) const
+{
+  assert(index >= 0 && index < chunk_count && "Invalid chunk index");
+
+  std::shared_lock lock{m_mutex};
+  return m_existing_chunks.test(index);
+}
+
+bool RegionFile::read(const int index, const std::function<bool(const char*, std::size_t)>& reader) const
+{
+  assert(index >= 0 && index < chunk_count && "Invalid chunk index");
+
+  {
+    std::shared_lock lock{m_mutex};
+
+    if (m_mapped_file != nullptr)
+    {
+      return m_read(index, reader);
+    }
+  }
+
+  // The file was written since the last read, map it again
+  std::unique_lock lock{m_mutex};
+
+  if (m_mapped_file == nullptr && m_existing_chunks.test(index))
+  {
+    m_mapped_file = std::make_unique<MappedFile>(m_filepath.string());
+  }
+
+  const bool result = m_read(index, reader);
+
+  // Try again on the next read
+  if (m_mapped_file != nullptr && !m_mapped_file->is_open())
+  {
+    m_mapped_file = nullptr;
+  }
+
+  return result;
+}
+
+void RegionFile::write(const int index, const std::vector<char>& data)
+{
+  std::vector<std::pair<int, std::vector<char>>> chunks{};
+  chunks.emplace_back(index, data);
+  write(chunks);
+}
+
+void RegionFile::write(const std::vector<std::pair<int, std::vector<char>>>& chunks)
+{
+  std::unique_lock lock{m_mutex};
+
+  // Release the mapping before writing, it can't be written while it's mapped on some platforms
+  m_mapped_file = nullptr;
+
+  if (!std::filesystem::exists(m_filepath))
+  {
+    m_write_header();
+  }
+
+  std::fstream file{m_filepath, std::ios::binary | std::ios::in | std::ios::out};
+
+  if (!file.is_open())
+  {
+    spdlog::critical("Could not open region file: {}", m_filepath.string());
+    return;
+  }
+
+  // Only applied to the table once the data is written
+  auto entries = m_entries;
+  auto existing_chunks = m_existing_chunks;
+  std::size_t unused_size = m_unused_size;
+  std::vector<char> buffer{};
+
+  for (const auto& [index, data] : chunks)
+  {
+    assert(index >= 0 && index < chunk_count && "Invalid chunk index");
+
+    auto& entry = entries[index];
+
+    if (existing_chunks.test(index))
+    {
+      unused_size += entry.size;
+    }
+
+    entry.offset = static_cast<uint32_t>(m_file_size + buffer.size());
+    entry.size = static_cast<uint32_t>(data.size());
+    existing_chunks.set(index);
+    buffer.insert(buffer.end(), data.begin(), data.end());
+  }
+
+  file.seekp(m_file_size);
+  file.write(buffer.data(), buffer.size());
+  file.close();
+
+  if (!file)
+  {
+    spdlog::critical("Could not write region file: {}", m_filepath.string());
+    return;
+  }
+
+  m_entries = entries;
+  m_existing_chunks = existing_chunks;
+  m_unused_size = unused_size;
+  m_file_size += buffer.size();
+  m_write_header();
+
+  if (m_unused_size >= min_compact_size && m_unused_size * 2 > m_file_size)
+  {
+    m_compact();
+  }
+}
+
+bool RegionFile::m_read(const int index, const std::function<bool(const char*, std::size_t)>& reader) const
+{
+  if (!m_existing_chunks.test(index))
+  {
+    return false;
+  }
+
+  const auto& entry = m_entries[index];
+
+  if (!m_mapped_file->is_open() || static_cast<std::size_t>(entry.offset) + entry.size > m_mapped_file->size())
+  {
+    spdlog::critical("Invalid chunk entry in region file: {}", m_filepath.string());
+    return false;
+  }
+
+  return reader(m_mapped_file->data() + entry.offset, entry.size);
+}
+
+void RegionFile::m_load_header()
+{
+  m_file_size = header_size;
+
+  if (!std::filesystem::exists(m_filepath))
+  {
+    return;
+  }
+
+  std::ifstream file{m_filepath, std::ios::binary};
+  std::vector<char> header(header_size);
+  file.read(header.data(), header.size());
+
+  uint32_t magic_number = 0;
+  memcpy(&magic_number, header.data(), sizeof(uint32_t));
+
+  if (!file || magic_number != region_magic_number)
+  {
+    spdlog::critical("Invalid region file: {}", m_filepath.string());
+    return;
+  }
+
+  std::size_t used_size = header_size;
+
+  for (int i = 0; i < chunk_count; ++i)
+  {
+    auto& entry = m_entries[i];
+    memcpy(&entry, header.data() + sizeof(uint32_t) + i * entry_size, entry_size);
+
+    if (entry.size > 0)
+    {
+      m_existing_chunks.set(i);
+      used_size += entry.size;
+    }
+  }
+
+  m_file_size = std::filesystem::file_size(m_filepath);
+  m_unused_size = m_file_size > used_size ? m_file_size - used_size : 0;
+}
+
+void RegionFile::m_write_header() const
+{
+  std::vector<char> header(header_size);
+  memcpy(header.data(), &region_magic_number, sizeof(uint32_t));
+
+  for (int i = 0; i < chunk_count; ++i)
+  {
+    memcpy(header.data() + sizeof(uint32_t) + i * entry_size, &m_entries[i], entry_size);
+  }
+
+  const auto mode = std::filesystem::exists(m_filepath) ? std::ios::binary | std::ios::in | std::ios::out
+                                                        : std::ios::binary | std::ios::out;
+  std::fstream file{m_filepath, mode};
+
+  if (!file.is_open())
+  {
+    spdlog::critical("Could not write region file header: {}", m_filepath.string());
+    return;
+  }
+
+  file.seekp(0);
+  file.write(header.data(), header.size());
+}
+
+void RegionFile::m_compact()
+{
+  std::vector<char> buffer(header_size);
+  auto entries = m_entries;
+
+  {
+    const MappedFile file{m_filepath.string()};
+
+    if (!file.is_open())
+    {
+      return;
+    }
+
+    for (int i = 0; i < chunk_count; ++i)
+    {
+      if (!m_existing_chunks.test(i))
+      {
+        continue;
+      }
+
+      const auto& entry = m_entries[i];
+      entries[i].offset = static_cast<uint32_t>(buffer.size());
+      buffer.insert(buffer.end(), file.data() + entry.offset, file.data() + entry.offset + entry.size);
+    }
+  }
+
+  memcpy(buffer.data(), &region_magic_number, sizeof(uint32_t));
+
+  for (int i = 0; i < chunk_count; ++i)
+  {
+    memcpy(buffer.data() + sizeof(uint32_t) + i * entry_size, &entries[i], entry_size);
+  }
+
+  auto temporary_filepath = m_filepath;
+  temporary_filepath += ".tmp";
+
+  {
+    std::ofstream file{temporary_filepath, std::ios::binary | std::ios::out | std::ios::trunc};
+
+    if (!file.is_open())
+    {
+      spdlog::critical("Could not compact region file: {}", m_filepath.string());
+      return;
+    }
+
+    file.write(buffer.data(), buffer.size());
+  }
+
+  std::error_code error_code{};
+  std::filesystem::rename(temporary_filepath, m_filepath, error_code);
+
+  // The old file is still valid, keep using it
+  if (error_code)
+  {
+    spdlog::critical("Could not replace region file {}: {}", m_filepath.string(), error_code.message());
+    std::filesystem::remove(temporary_filepath, error_code);
+    return;
+  }
+
+  spdlog::debug("Compacted region file {}: {} -> {} bytes", m_filepath.string(), m_file_size, buffer.size());
+
+  m_entries = entries;
+  m_file_size = buffer.size();
+  m_unused_size = 0;
+}
+}  // namespace dl
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include "core/mapped_file.hpp"
+#include "core/maths/vector.hpp"
+
+namespace dl
+{
+// Container that stores the data of region_size * region_size chunks in a
+// single file. The file starts with a table holding the offset and size of
+// each chunk, which is kept in memory so that checking whether a chunk exists
+// doesn't touch the disk. Chunks are always appended to the end of the file
+// and the file is compacted once most of it is made of overwritten data. The
+// file stays mapped between reads so that chunks can be read concurrently,
+// writes unmap it until the next read.
+class RegionFile
+{
+ public:
+  static constexpr int region_size = 16;
+  static constexpr int chunk_count = region_size * region_size;
+
+  RegionFile(const std::filesystem::path& filepath);
+
+  RegionFile(const RegionFile&) = delete;
+  RegionFile& operator=(const RegionFile&) = delete;
+
+  // Position of the region that contains a chunk, in region units
+  static Vector3i get_region_position(const Vector3i& chunk_position);
+  // Index of a chunk inside its region
+  static int get_chunk_index(const Vector3i& chunk_position);
+
+  bool contains(const int index) const;
+
+  // Calls reader with the stored data of a chunk, the data is only valid during the call.
+  // Returns false if the chunk is not in the region or if the reader fails.
+  bool read(const int index, const std::function<bool(const char*, std::size_t)>& reader) const;
+
+  // Appends the data of one or more chunks with a single write
+  void write(const int index, const std::vector<char>& data);
+  void write(const std::vector<std::pair<int, std::vector<char>>>& chunks);
+
+ private:
+  struct Entry
+  {
+    uint32_t offset = 0;
+    uint32_t size = 0;
+  };
+
+  std::filesystem::path m_filepath{};
+  std::array<Entry, chunk_count> m_entries{};
+  std::bitset<chunk_count> m_existing_chunks{};
+  std::size_t m_file_size = 0;
+  // Bytes taken by chunks that were written again
+  std::size_t m_unused_size = 0;
+  // Mapped on the first read after a write
+  mutable std::unique_ptr<MappedFile> m_mapped_file = nullptr;
+  // Shared by readers, writes are exclusive
+  mutable std::shared_mutex m_mutex{};
+
+  bool m_read(const int index, const std::function<bool(const char*, std::size_t)>& reader) const;
+  void m_load_header();
+  void m_write_header() const;
+  void m_compact();
+};
+}  // namespace dl
@@ -19,10 +19,19 @@
 #include <entt/core/hashed_string.hpp>
 #include <entt/entity/registry.hpp>
 #include <entt/entity/snapshot.hpp>
+#include <algorithm>
+#include <array>
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "constants.hpp"
+#include "core/mapped_file.hpp"
+#include "core/region_file.hpp"
 #include "ecs/components/action_pickup.hpp"
 #include "ecs/components/action_walk.hpp"
 #include "ecs/components/biology.hpp"
@@ -53,14 +62,165 @@ constexpr uint8_t end_marker = 0x04;
 constexpr std::size_t magic_number_size = sizeof(uint32_t);
 constexpr std::size_t marker_size = sizeof(uint8_t);
 constexpr std::size_t cell_size = sizeof(Cell);
-constexpr std::size_t markers_size = marker_size * 4;
 constexpr std::size_t chunk_size_size = sizeof(Vector3i);
-constexpr std::size_t cell_values_size = cell_size * world::chunk_size.x * world::chunk_size.y * world::chunk_size.z;
 constexpr std::size_t height_map_size = sizeof(int) * world::chunk_size.x * world::chunk_size.y;
-constexpr std::size_t chunk_data_buffer_size
-    = magic_number_size + markers_size + chunk_size_size + cell_values_size + height_map_size;
+
+// Compressed format. Cells are stored as indices into a palette of distinct
+// cells, run length encoded per z slice. The header contains the offset of each
+// slice so that empty slices take no space and aren't touched when loading.
+constexpr uint32_t compressed_magic_number = 0x533e;
+constexpr uint8_t palette_marker = 0x05;
+constexpr uint8_t slices_marker = 0x06;
+
+constexpr std::size_t packed_cell_size = sizeof(uint32_t) * 4 + sizeof(uint8_t) * 2;
+constexpr std::size_t run_size = sizeof(uint16_t) + sizeof(uint32_t);
+constexpr uint32_t max_run_length = std::numeric_limits<uint16_t>::max();
 }  // namespace terrain_ext
 
+namespace
+{
+using CellKey = std::array<uint32_t, 5>;
+
+CellKey get_cell_key(const Cell& cell)
+{
+  return CellKey{cell.top_face,
+                 cell.front_face,
+                 cell.top_face_decoration,
+                 cell.front_face_decoration,
+                 static_cast<uint32_t>(cell.flags) | (static_cast<uint32_t>(cell.block_type) << 8)};
+}
+
+bool is_empty_cell(const Cell& cell) { return get_cell_key(cell) == get_cell_key(Cell{}); }
+
+template <typename T>
+void write_value(std::vector<char>& buffer, const T& value)
+{
+  const auto offset = buffer.size();
+  buffer.resize(offset + sizeof(T));
+  memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+// Reads a value from a buffer advancing the offset, returns false if the buffer is too small
+template <typename T>
+bool read_value(const char* data, const std::size_t size, std::size_t& offset, T& value)
+{
+  if (offset + sizeof(T) > size)
+  {
+    return false;
+  }
+
+  memcpy(&value, data + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+bool read_marker(const char* data, const std::size_t size, std::size_t& offset, const uint8_t expected)
+{
+  uint8_t marker = 0;
+
+  if (!read_value(data, size, offset, marker) || marker != expected)
+  {
+    spdlog::critical("Invalid marker when loading chunk: {}, expected: {}", marker, expected);
+    return false;
+  }
+
+  return true;
+}
+
+bool read_packed_cell(const char* data, const std::size_t size, std::size_t& offset, Cell& cell)
+{
+  uint8_t block_type = 0;
+
+  const bool success = read_value(data, size, offset, cell.top_face) && read_value(data, size, offset, cell.front_face)
+                       && read_value(data, size, offset, cell.top_face_decoration)
+                       && read_value(data, size, offset, cell.front_face_decoration)
+                       && read_value(data, size, offset, cell.flags) && read_value(data, size, offset, block_type);
+
+  cell.block_type = static_cast<BlockType>(block_type);
+  return success;
+}
+
+void write_packed_cell(std::vector<char>& buffer, const Cell& cell)
+{
+  write_value(buffer, cell.top_face);
+  write_value(buffer, cell.front_face);
+  write_value(buffer, cell.top_face_decoration);
+  write_value(buffer, cell.front_face_decoration);
+  write_value(buffer, cell.flags);
+  write_value(buffer, static_cast<uint8_t>(cell.block_type));
+}
+
+std::string get_chunk_file_path(const Vector3i& position, const std::string& world_id)
+{
+  return fmt::format("{}/{}/{}/{}_{}_{}.chunk",
+                     directory::worlds.string(),
+                     world_id,
+                     directory::chunks.string(),
+                     position.x,
+                     position.y,
+                     position.z);
+}
+
+std::mutex regions_mutex{};
+// Region files stay loaded for the whole session, they only keep the table of their chunks in memory
+std::unordered_map<std::string, std::unique_ptr<RegionFile>> region_files{};
+// Chunks saved to separate files before region files were introduced, listed once per world
+std::unordered_map<std::string, std::unordered_set<uint64_t>> legacy_chunks{};
+
+std::filesystem::path get_region_file_path(const Vector3i& chunk_position, const std::string& world_id)
+{
+  const auto region_position = RegionFile::get_region_position(chunk_position);
+  const auto filename = fmt::format("{}_{}_{}.region", region_position.x, region_position.y, region_position.z);
+  return directory::worlds / world_id / directory::regions / filename;
+}
+
+RegionFile& get_region_file(const Vector3i& chunk_position, const std::string& world_id)
+{
+  const auto region_file_path = get_region_file_path(chunk_position, world_id);
+
+  std::scoped_lock lock{regions_mutex};
+  auto& region_file = region_files[region_file_path.string()];
+
+  if (region_file == nullptr)
+  {
+    region_file = std::make_unique<RegionFile>(region_file_path);
+  }
+
+  return *region_file;
+}
+
+bool legacy_chunk_exists(const Vector3i& position, const std::string& world_id)
+{
+  std::scoped_lock lock{regions_mutex};
+  const auto [it, inserted] = legacy_chunks.try_emplace(world_id);
+  auto& chunk_keys = it->second;
+
+  if (inserted)
+  {
+    const auto chunks_directory = directory::worlds / world_id / directory::chunks;
+    std::error_code error_code{};
+
+    for (const auto& entry : std::filesystem::directory_iterator{chunks_directory, error_code})
+    {
+      Vector3i chunk_position{};
+
+      if (entry.path().extension() == ".chunk"
+          && sscanf(entry.path().stem().string().c_str(),
+                    "%d_%d_%d",
+                    &chunk_position.x,
+                    &chunk_position.y,
+                    &chunk_position.z)
+                 == 3)
+      {
+        chunk_keys.insert(ChunkManager::chunk_key(chunk_position));
+      }
+    }
+  }
+
+  return chunk_keys.contains(ChunkManager::chunk_key(position));
+}
+}  // namespace
+
 void initialize_directories()
 {
   if (!std::filesystem::exists(directory::data))
@@ -231,68 +391,15 @@ bool chunk_exists(const Vector3i& position, const std::string& world_id)
   assert(position.x % world::chunk_size.x == 0 && position.y % world::chunk_size.y == 0
          && position.z % world::chunk_size.z == 0 && "Position is not a chunk position.");
 
-  const auto filename = fmt::format("{}_{}_{}.chunk", position.x, position.y, position.z);
-  const auto full_path = directory::worlds / world_id / directory::chunks / filename;
-  return std::filesystem::exists(full_path);
+  return get_region_file(position, world_id).contains(RegionFile::get_chunk_index(position))
+         || legacy_chunk_exists(position, world_id);
 }
 
-void save_game_chunk(const Chunk& chunk, const std::string& world_id)
+namespace
 {
-  const auto chunk_file_path = fmt::format("{}/{}/{}/{}_{}_{}.chunk",
-                                           directory::worlds.string(),
-                                           world_id,
-                                           directory::chunks.string(),
-                                           chunk.position.x,
-                                           chunk.position.y,
-                                           chunk.position.z);
-
-  std::ofstream outfile{chunk_file_path.c_str(), std::ios::binary | std::ios::out};
-
-  if (!outfile.is_open())
-  {
-    spdlog::critical("Could not open file to save chunk: {}", chunk_file_path);
-    return;
-  }
-
-  char buffer[terrain_ext::chunk_data_buffer_size] = {0};
-
-  std::size_t offset = 0;
-  memcpy(buffer, reinterpret_cast<const char*>(&terrain_ext::magic_number), terrain_ext::magic_number_size);
-  offset += terrain_ext::magic_number_size;
-  memcpy(buffer + offset, reinterpret_cast<const char*>(&terrain_ext::metadata_marker), terrain_ext::marker_size);
-  offset += terrain_ext::marker_size;
-  memcpy(buffer + offset, reinterpret_cast<const char*>(&chunk.tiles.size), terrain_ext::chunk_size_size);
-  offset += terrain_ext::chunk_size_size;
-  memcpy(buffer + offset, reinterpret_cast<const char*>(&terrain_ext::values_marker), terrain_ext::marker_size);
-  offset += terrain_ext::marker_size;
-  memcpy(buffer + offset, reinterpret_cast<const char*>(chunk.tiles.values.data()), terrain_ext::cell_values_size);
-  offset += terrain_ext::cell_values_size;
-  memcpy(buffer + offset, reinterpret_cast<const char*>(&terrain_ext::height_map_marker), terrain_ext::marker_size);
-  offset += terrain_ext::marker_size;
-  memcpy(buffer + offset, reinterpret_cast<const char*>(chunk.tiles.height_map.data()), terrain_ext::height_map_size);
-  offset += terrain_ext::height_map_size;
-  memcpy(buffer + offset, reinterpret_cast<const char*>(&terrain_ext::end_marker), terrain_ext::marker_size);
-
-  outfile.write(buffer, terrain_ext::chunk_data_buffer_size);
-  outfile.close();
-}
-
-void load_game_chunk(Chunk& chunk, const std::string& world_id)
+// Reads the uncompressed format used before the compressed one was introduced
+void load_legacy_game_chunk(Chunk& chunk, const std::string& chunk_file_path)
 {
-  const auto chunk_file_path = fmt::format("{}/{}/{}/{}_{}_{}.chunk",
-                                           directory::worlds.string(),
-                                           world_id,
-                                           directory::chunks.string(),
-                                           chunk.position.x,
-                                           chunk.position.y,
-                                           chunk.position.z);
-
-  if (!std::filesystem::exists(chunk_file_path))
-  {
-    spdlog::critical("Chunk file doest not does not exist: {}", chunk_file_path.c_str());
-    return;
-  }
-
 #ifdef _WIN32
   FILE* file = _wfopen(chunk_file_path.c_str(), L"r");
 #else
@@ -405,4 +512,330 @@ void load_game_chunk(Chunk& chunk, const std::string& world_id)
 
   fclose(file);
 }
+
+// Decodes a chunk in the compressed format, returns false if the data is invalid
+bool load_compressed_game_chunk(Chunk& chunk, const char* data, const std::size_t size)
+{
+  auto& tiles = chunk.tiles;
+  std::size_t offset = terrain_ext::magic_number_size;
+
+  if (!read_marker(data, size, offset, terrain_ext::metadata_marker))
+  {
+    return false;
+  }
+
+  Vector3i chunk_size{};
+
+  if (!read_value(data, size, offset, chunk_size.x) || !read_value(data, size, offset, chunk_size.y)
+      || !read_value(data, size, offset, chunk_size.z))
+  {
+    return false;
+  }
+
+  if (chunk_size.x != tiles.size.x || chunk_size.y != tiles.size.y || chunk_size.z != tiles.size.z)
+  {
+    spdlog::critical("Chunk size in file ({}, {}, {}) doesn't match the expected size ({}, {}, {})",
+                     chunk_size.x,
+                     chunk_size.y,
+                     chunk_size.z,
+                     tiles.size.x,
+                     tiles.size.y,
+                     tiles.size.z);
+    return false;
+  }
+
+  uint32_t palette_size = 0;
+
+  if (!read_marker(data, size, offset, terrain_ext::palette_marker) || !read_value(data, size, offset, palette_size))
+  {
+    return false;
+  }
+
+  std::vector<Cell> palette(palette_size);
+
+  for (auto& cell : palette)
+  {
+    if (!read_packed_cell(data, size, offset, cell))
+    {
+      return false;
+    }
+  }
+
+  if (!read_marker(data, size, offset, terrain_ext::slices_marker))
+  {
+    return false;
+  }
+
+  std::vector<uint32_t> slice_offsets(tiles.size.z + 1);
+
+  for (auto& slice_offset : slice_offsets)
+  {
+    if (!read_value(data, size, offset, slice_offset))
+    {
+      return false;
+    }
+  }
+
+  const uint32_t slice_cell_count = tiles.size.x * tiles.size.y;
+
+  for (int z = 0; z < tiles.size.z; ++z)
+  {
+    // Empty slices have no data, the cells keep their default value
+    std::size_t slice_offset = slice_offsets[z];
+    const std::size_t slice_end = std::min(static_cast<std::size_t>(slice_offsets[z + 1]), size);
+    auto cell_it = tiles.values.begin() + z * slice_cell_count;
+    uint32_t decoded_count = 0;
+
+    while (slice_offset < slice_end)
+    {
+      uint16_t run_length = 0;
+      uint32_t palette_index = 0;
+
+      if (!read_value(data, slice_end, slice_offset, run_length)
+          || !read_value(data, slice_end, slice_offset, palette_index) || palette_index >= palette.size()
+          || decoded_count + run_length > slice_cell_count)
+      {
+        spdlog::critical("Invalid run when loading chunk slice {}", z);
+        return false;
+      }
+
+      std::fill_n(cell_it + decoded_count, run_length, palette[palette_index]);
+      decoded_count += run_length;
+    }
+  }
+
+  offset = slice_offsets[tiles.size.z];
+
+  if (!read_marker(data, size, offset, terrain_ext::height_map_marker))
+  {
+    return false;
+  }
+
+  const std::size_t height_map_size = tiles.height_map.size() * sizeof(int);
+
+  if (offset + height_map_size > size)
+  {
+    return false;
+  }
+
+  memcpy(tiles.height_map.data(), data + offset, height_map_size);
+  offset += height_map_size;
+
+  return read_marker(data, size, offset, terrain_ext::end_marker);
+}
+
+// Encodes a chunk in the compressed format
+std::vector<char> encode_game_chunk(const Chunk& chunk)
+{
+  const auto& tiles = chunk.tiles;
+  const uint32_t slice_cell_count = tiles.size.x * tiles.size.y;
+
+  std::vector<Cell> palette{};
+  std::map<CellKey, uint32_t> palette_indices{};
+
+  const auto get_palette_index = [&palette, &palette_indices](const Cell& cell)
+  {
+    const auto [it, inserted] = palette_indices.emplace(get_cell_key(cell), static_cast<uint32_t>(palette.size()));
+
+    if (inserted)
+    {
+      palette.push_back(cell);
+    }
+
+    return it->second;
+  };
+
+  // Encode the slices first, the offsets are adjusted once the header size is known
+  std::vector<char> slices{};
+  std::vector<uint32_t> slice_offsets(tiles.size.z + 1, 0);
+
+  for (int z = 0; z < tiles.size.z; ++z)
+  {
+    slice_offsets[z] = slices.size();
+
+    // Read through cell_at_index so that compact grids can be saved too
+    const std::size_t slice_begin = z * slice_cell_count;
+    const std::size_t slice_end = slice_begin + slice_cell_count;
+    bool is_empty_slice = true;
+
+    for (std::size_t i = slice_begin; i < slice_end; ++i)
+    {
+      if (!is_empty_cell(tiles.cell_at_index(i)))
+      {
+        is_empty_slice = false;
+        break;
+      }
+    }
+
+    if (is_empty_slice)
+    {
+      continue;
+    }
+
+    auto run_begin = slice_begin;
+
+    while (run_begin != slice_end)
+    {
+      const auto& cell = tiles.cell_at_index(run_begin);
+      const auto key = get_cell_key(cell);
+      auto run_end = run_begin + 1;
+
+      while (run_end != slice_end && run_end - run_begin < terrain_ext::max_run_length
+             && get_cell_key(tiles.cell_at_index(run_end)) == key)
+      {
+        ++run_end;
+      }
+
+      write_value(slices, static_cast<uint16_t>(run_end - run_begin));
+      write_value(slices, get_palette_index(cell));
+      run_begin = run_end;
+    }
+  }
+
+  slice_offsets[tiles.size.z] = slices.size();
+
+  const std::size_t header_size = terrain_ext::magic_number_size + terrain_ext::marker_size
+                                  + terrain_ext::chunk_size_size + terrain_ext::marker_size + sizeof(uint32_t)
+                                  + palette.size() * terrain_ext::packed_cell_size + terrain_ext::marker_size
+                                  + slice_offsets.size() * sizeof(uint32_t);
+
+  std::vector<char> buffer{};
+  buffer.reserve(header_size + slices.size() + tiles.height_map.size() * sizeof(int) + terrain_ext::marker_size * 2);
+
+  write_value(buffer, terrain_ext::compressed_magic_number);
+  write_value(buffer, terrain_ext::metadata_marker);
+  write_value(buffer, tiles.size.x);
+  write_value(buffer, tiles.size.y);
+  write_value(buffer, tiles.size.z);
+  write_value(buffer, terrain_ext::palette_marker);
+  write_value(buffer, static_cast<uint32_t>(palette.size()));
+
+  for (const auto& cell : palette)
+  {
+    write_packed_cell(buffer, cell);
+  }
+
+  write_value(buffer, terrain_ext::slices_marker);
+
+  for (const auto slice_offset : slice_offsets)
+  {
+    write_value(buffer, static_cast<uint32_t>(slice_offset + header_size));
+  }
+
+  assert(buffer.size() == header_size && "Unexpected chunk header size");
+
+  buffer.insert(buffer.end(), slices.begin(), slices.end());
+  write_value(buffer, terrain_ext::height_map_marker);
+
+  const auto height_map_offset = buffer.size();
+  buffer.resize(height_map_offset + tiles.height_map.size() * sizeof(int));
+  memcpy(buffer.data() + height_map_offset, tiles.height_map.data(), tiles.height_map.size() * sizeof(int));
+
+  write_value(buffer, terrain_ext::end_marker);
+
+  return buffer;
+}
+
+// Loads a chunk saved to its own file before region files were introduced, returns the size of the file or 0 if
+// the chunk couldn't be loaded
+std::size_t load_game_chunk_file(Chunk& chunk, const std::string& chunk_file_path)
+{
+  if (!std::filesystem::exists(chunk_file_path))
+  {
+    spdlog::critical("Chunk file doest not does not exist: {}", chunk_file_path.c_str());
+    return 0;
+  }
+
+  const MappedFile file{chunk_file_path};
+  uint32_t file_magic_number = 0;
+  std::size_t offset = 0;
+
+  if (!file.is_open() || !read_value(file.data(), file.size(), offset, file_magic_number))
+  {
+    spdlog::critical("Could not open file for loading chunk.");
+    return 0;
+  }
+
+  if (file_magic_number == terrain_ext::magic_number)
+  {
+    load_legacy_game_chunk(chunk, chunk_file_path);
+  }
+  else if (file_magic_number == terrain_ext::compressed_magic_number)
+  {
+    if (!load_compressed_game_chunk(chunk, file.data(), file.size()))
+    {
+      spdlog::critical("Could not load chunk: {}", chunk_file_path);
+      return 0;
+    }
+  }
+  else
+  {
+    spdlog::critical("Invalid file format when loading chunk: {:x}, expected: {:x}",
+                     file_magic_number,
+                     terrain_ext::compressed_magic_number);
+    return 0;
+  }
+
+  return file.size();
+}
+}  // namespace
+
+void save_game_chunk(const Chunk& chunk, const std::string& world_id) { save_game_chunks({&chunk}, world_id); }
+
+void save_game_chunks(const std::vector<const Chunk*>& chunks, const std::string& world_id)
+{
+  const auto regions_directory = directory::worlds / world_id / directory::regions;
+
+  if (!std::filesystem::exists(regions_directory))
+  {
+    std::filesystem::create_directories(regions_directory);
+  }
+
+  // Group the chunks by region so that each region file is written once
+  std::unordered_map<RegionFile*, std::vector<std::pair<int, std::vector<char>>>> region_chunks{};
+
+  for (const auto chunk : chunks)
+  {
+    auto& region_file = get_region_file(chunk->position, world_id);
+    auto buffer = encode_game_chunk(*chunk);
+    region_chunks[&region_file].emplace_back(RegionFile::get_chunk_index(chunk->position), std::move(buffer));
+  }
+
+  for (const auto& [region_file, encoded_chunks] : region_chunks)
+  {
+    region_file->write(encoded_chunks);
+  }
+}
+
+void load_game_chunk(Chunk& chunk, const std::string& world_id)
+{
+  const auto& region_file = get_region_file(chunk.position, world_id);
+  const auto chunk_index = RegionFile::get_chunk_index(chunk.position);
+
+  if (region_file.contains(chunk_index))
+  {
+    const auto read_chunk = [&chunk](const char* data, const std::size_t size)
+    {
+      uint32_t magic_number = 0;
+      std::size_t offset = 0;
+
+      return read_value(data, size, offset, magic_number) && magic_number == terrain_ext::compressed_magic_number
+             && load_compressed_game_chunk(chunk, data, size);
+    };
+
+    if (!region_file.read(chunk_index, read_chunk))
+    {
+      spdlog::critical(
+          "Could not load chunk ({}, {}, {}) from region file", chunk.position.x, chunk.position.y, chunk.position.z);
+      return;
+    }
+  }
+  else if (load_game_chunk_file(chunk, get_chunk_file_path(chunk.position, world_id)) == 0)
+  {
+    return;
+  }
+
+  // The visibility index is not saved, it's rebuilt from the loaded flags
+  chunk.tiles.compute_visible_levels();
+}
 }  // namespace dl::serialization
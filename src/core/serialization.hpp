@@ -3,6 +3,7 @@
 #include <entt/entity/fwd.hpp>
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include "world/metadata.hpp"
 
@@ -27,5 +28,7 @@ void load_game(World& world, const WorldMetadata& world_metadata, entt::registry
 
 bool chunk_exists(const Vector3i& position, const std::string& world_id);
 void save_game_chunk(const Chunk& chunk, const std::string& world_id);
+// Saves several chunks writing each region file only once
+void save_game_chunks(const std::vector<const Chunk*>& chunks, const std::string& world_id);
 void load_game_chunk(Chunk& chunk, const std::string& world_id);
 }  // namespace dl::serialization
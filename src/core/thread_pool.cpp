@@ -4,9 +4,9 @@
 
 namespace dl
 {
-void ThreadPool::initialize()
+void ThreadPool::initialize(const size_t thread_count)
 {
-  const size_t max_threads = std::thread::hardware_concurrency();
+  const size_t max_threads = thread_count > 0 ? thread_count : std::thread::hardware_concurrency();
 
   for (size_t i = 0; i < max_threads; ++i)
   {
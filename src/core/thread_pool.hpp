@@ -12,7 +12,8 @@ namespace dl
 class ThreadPool
 {
  public:
-  void initialize();
+  // Spawns one thread per hardware thread if thread_count is zero
+  void initialize(const size_t thread_count = 0);
   void queue_job(const std::function<void()>& job);
   void finalize();
   bool is_busy();
@@ -91,6 +91,10 @@ void DebugTools::update()
   {
     m_camera_inspector->update();
   }
+  if (m_pathfinding_info != nullptr)
+  {
+    m_pathfinding_info->update();
+  }
   if (m_render_editor != nullptr)
   {
     m_render_editor->update();
@@ -130,6 +134,10 @@ void DebugTools::m_update_menu_bar()
       {
         ImGui::MenuItem("Camera Inspector", NULL, &m_camera_inspector->open);
       }
+      if (m_pathfinding_info != nullptr)
+      {
+        ImGui::MenuItem("Pathfinding", NULL, &m_pathfinding_info->open);
+      }
       if (m_camera_inspector != nullptr)
       {
         ImGui::MenuItem("Chunk Debugger", NULL, &m_chunk_debugger->open);
@@ -159,6 +167,11 @@ void DebugTools::init_camera_inspector(Camera& camera)
   m_camera_inspector = std::make_unique<CameraInspector>(camera);
 }
 
+void DebugTools::init_pathfinding_info(const WalkSystem& walk_system)
+{
+  m_pathfinding_info = std::make_unique<PathfindingInfo>(walk_system);
+}
+
 void DebugTools::init_render_editor(RenderSystem& render)
 {
   m_render_editor = std::make_unique<RenderEditor>(render);
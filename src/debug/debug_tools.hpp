@@ -5,6 +5,7 @@
 #include "./camera_inspector.hpp"
 #include "./chunk_debugger.hpp"
 #include "./general_info.hpp"
+#include "./pathfinding_info.hpp"
 #include "./render_editor.hpp"
 #include "./world_generation.hpp"
 
@@ -35,6 +36,7 @@ class DebugTools
   // Custom widgets
   void init_general_info(GameContext& context);
   void init_camera_inspector(Camera& camera);
+  void init_pathfinding_info(const WalkSystem& walk_system);
   void init_render_editor(RenderSystem& render);
   void init_chunk_debugger(Gameplay& gameplay);
   void init_world_generation(ChunkManager& chunk_manager);
@@ -45,6 +47,7 @@ class DebugTools
 
   std::unique_ptr<GeneralInfo> m_general_info = nullptr;
   std::unique_ptr<CameraInspector> m_camera_inspector = nullptr;
+  std::unique_ptr<PathfindingInfo> m_pathfinding_info = nullptr;
   std::unique_ptr<RenderEditor> m_render_editor = nullptr;
   std::unique_ptr<ChunkDebugger> m_chunk_debugger = nullptr;
   std::unique_ptr<WorldGeneration> m_world_generation = nullptr;
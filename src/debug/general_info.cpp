@@ -13,6 +13,7 @@
 
 #include "core/game_context.hpp"
 #include "definitions.hpp"
+#include "graphics/renderer/renderer.hpp"
 #include "imgui.h"
 #include "implot.h"
 
@@ -182,6 +183,12 @@ void GeneralInfo::update()
     ImGui::Text("FPS: %.1f", static_cast<float>(1.0 / m_game_context.clock->delta));
     ImGui::Text("MS: %.3f", static_cast<float>(m_game_context.clock->delta));
 
+    if (m_game_context.renderer != nullptr)
+    {
+      m_render_batch_info("World", m_game_context.renderer->main_pass.batch.get_stats());
+      m_render_batch_info("UI", m_game_context.renderer->ui_pass.batch.get_stats());
+    }
+
 #ifdef DL_HAS_SUPPORTED_PLATFORM_FOR_USAGE
     m_render_usage_info();
 #endif
@@ -190,6 +197,16 @@ void GeneralInfo::update()
   ImGui::End();
 }
 
+void GeneralInfo::m_render_batch_info(const char* name, const BatchStats& stats)
+{
+  ImGui::Text("%s: %u quads, %u/%u buffers, %.1fKB uploaded",
+              name,
+              stats.quad_count,
+              stats.buffer_count,
+              stats.pooled_buffer_count,
+              stats.uploaded_bytes / 1024.0f);
+}
+
 #ifdef DL_HAS_SUPPORTED_PLATFORM_FOR_USAGE
 void GeneralInfo::m_render_usage_info()
 {
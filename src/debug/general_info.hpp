@@ -3,6 +3,7 @@
 namespace dl
 {
 struct GameContext;
+struct BatchStats;
 
 class GeneralInfo
 {
@@ -18,5 +19,6 @@ class GeneralInfo
   GameContext& m_game_context;
 
   void m_render_usage_info();
+  void m_render_batch_info(const char* name, const BatchStats& stats);
 };
 }  // namespace dl
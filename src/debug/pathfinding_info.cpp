@@ -0,0 +1,29 @@
+#include "./pathfinding_info.hpp"
+
+#include "ecs/systems/walk.hpp"
+#include "imgui.h"
+
+namespace dl
+{
+PathfindingInfo::PathfindingInfo(const WalkSystem& walk_system) : m_walk_system(walk_system) {}
+
+void PathfindingInfo::update()
+{
+  if (!open)
+  {
+    return;
+  }
+
+  if (ImGui::Begin("Pathfinding", &open, ImGuiWindowFlags_NoFocusOnAppearing))
+  {
+    const auto stats = m_walk_system.get_pathfinding_stats();
+
+    ImGui::Text("Queue depth: %zu", stats.queue_depth);
+    ImGui::Text("Solved: %zu", stats.solved);
+    ImGui::Text("Latency: %.2fms average, %.2fms max", stats.average_latency_ms, stats.max_latency_ms);
+    ImGui::Text("Solve time: %.3fms average", stats.average_solve_ms);
+  }
+
+  ImGui::End();
+}
+}  // namespace dl
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace dl
+{
+class WalkSystem;
+
+class PathfindingInfo
+{
+ public:
+  bool open = true;
+
+  PathfindingInfo(const WalkSystem& walk_system);
+  void update();
+  void toggle() { open = !open; }
+
+ private:
+  const WalkSystem& m_walk_system;
+};
+}  // namespace dl
@@ -9,8 +9,12 @@ RenderEditor::RenderEditor(RenderSystem& render) : m_render(render) {}
 
 void RenderEditor::update()
 {
-  (void)m_render;
   ImGui::Begin("Render Editor", &m_open);
+
+  ImGui::SeparatorText("Chunk meshes");
+  ImGui::Text("Stale meshes: %d", m_render.m_chunk_mesher.get_stale_count());
+  ImGui::Text("Meshing jobs: %d", m_render.m_chunk_mesher.get_jobs_in_flight());
+
   /* ImGui::SeparatorText("Virtual Position"); */
   /* ImGui::DragInt("Frustum padding", &m_render.m_frustum_tile_padding, 1); */
   /* ImGui::DragScalar("vy", ImGuiDataType_Double, &m_render.position.y, 1.0); */
@@ -165,7 +165,7 @@ void ActionSystem::m_process_input(entt::registry& registry, const Camera& camer
       {
         m_actions.push_back({JobType::Wield, "wield"});
       }
-      if (tile_data.flags.contains("WALKABLE"))
+      if (tile_data.has_flags(DL_TILE_FLAG_WALKABLE))
       {
         m_actions.push_back({JobType::Walk, "walk to location"});
       }
@@ -189,7 +189,7 @@ void ActionSystem::m_process_input(entt::registry& registry, const Camera& camer
         m_actions.push_back({action.first, action.second.label});
       }
 
-      if (tile_data.flags.contains("WALKABLE"))
+      if (tile_data.has_flags(DL_TILE_FLAG_WALKABLE))
       {
         m_actions.push_back({JobType::Walk, "walk to location"});
       }
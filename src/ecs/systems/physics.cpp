@@ -103,9 +103,9 @@ void PhysicsSystem::update(entt::registry& registry)
             else
             {
               const auto climb_position = m_get_climb_position(position, candidate_position);
-              const auto& tile_data = m_world.get_top_face(climb_position.x, climb_position.y, climb_position.z);
+              const auto tile_id = m_world.top_face_at(climb_position.x, climb_position.y, climb_position.z);
 
-              if (tile_data.flags.contains("WALKABLE"))
+              if (m_world.has_tile_flags(tile_id, DL_TILE_FLAG_WALKABLE))
               {
                 target_position = climb_position;
               }
@@ -152,9 +152,7 @@ bool PhysicsSystem::m_collides(const int x, const int y, const int z, entt::regi
 {
   using namespace entt::literals;
 
-  auto& target_tile = m_world.get(x, y, z);
-
-  if (!target_tile.flags.contains("WALKABLE"))
+  if (!m_world.is_walkable(x, y, z))
   {
     return true;
   }
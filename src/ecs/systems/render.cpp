@@ -13,6 +13,7 @@
 #include "ecs/components/selectable.hpp"
 #include "ecs/components/sprite.hpp"
 #include "graphics/camera.hpp"
+#include "graphics/chunk_mesh.hpp"
 #include "graphics/frame_data_types.hpp"
 #include "graphics/quad.hpp"
 #include "graphics/renderer/batch.hpp"
@@ -27,7 +28,8 @@ RenderSystem::RenderSystem(GameContext& game_context, World& world)
       m_renderer(*m_game_context.renderer),
       m_batch(m_renderer.main_pass.batch),
       m_world(world),
-      m_tile_size(world.get_tile_size())
+      m_tile_size(world.get_tile_size()),
+      m_chunk_mesher(m_tiles, m_tile_size, m_z_index_increment)
 {
   assert(m_game_context.asset_manager != nullptr);
 
@@ -103,6 +105,8 @@ void RenderSystem::render(entt::registry& registry, const Camera& camera)
 
 void RenderSystem::m_render_map_tiles(const Camera& camera)
 {
+  m_chunk_mesher.update(m_world.chunk_manager, m_batch);
+
   const auto& camera_position = camera.get_position_in_tiles();
   const auto& camera_size = camera.get_size_in_tiles();
 
@@ -118,7 +122,7 @@ void RenderSystem::m_render_map_tiles(const Camera& camera)
     {
       for (int i = first_chunk_position.x; i <= camera_position.x + camera_size.x; i += world::chunk_size.x)
       {
-        const auto& chunk = m_world.chunk_manager.at(i, j, 0);
+        auto& chunk = m_world.chunk_manager.at(i, j, 0);
 
         if (chunk.tiles.height_map.empty())
         {
@@ -149,35 +153,22 @@ void RenderSystem::m_render_map_tiles(const Camera& camera)
               = world::chunk_size.x - ((i + world::chunk_size.x) - (camera_position.x + camera_size.x + padding));
         }
 
-        for (int local_j = lower_bound_j; local_j < upper_bound_j; ++local_j)
+        if (lower_bound_i >= upper_bound_i)
         {
-          for (int local_i = lower_bound_i; local_i < upper_bound_i; ++local_i)
-          {
-            const auto height = chunk.tiles.height_map[local_i + local_j * world::chunk_size.x];
+          continue;
+        }
 
-            for (int z = height; z >= 0; --z)
-            {
-              if (!chunk.tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, local_i, local_j, z)
-                  && !chunk.tiles.has_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, local_i, local_j, z))
-              {
-                continue;
-              }
-
-              const auto& cell = chunk.tiles.cell_at(local_i, local_j, z);
-              const Vector3i local_position{local_i, local_j, z};
-
-              if (chunk.tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, local_i, local_j, z))
-              {
-                m_render_map_tile(chunk, cell.top_face, local_position);
-                m_render_map_tile(chunk, cell.top_face_decoration, local_position, 1);
-              }
-              if (chunk.tiles.has_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, local_i, local_j, z))
-              {
-                m_render_map_tile(chunk, cell.front_face, local_position);
-                m_render_map_tile(chunk, cell.front_face_decoration, local_position, 1);
-              }
-            }
-          }
+        const auto* mesh = m_get_chunk_mesh(chunk);
+
+        if (mesh == nullptr)
+        {
+          continue;
+        }
+
+        // Columns of a row are contiguous in the mesh
+        for (int local_j = lower_bound_j; local_j < upper_bound_j; ++local_j)
+        {
+          m_batch.mesh(*mesh, mesh->column_begin(lower_bound_i, local_j), mesh->column_begin(upper_bound_i, local_j));
         }
       }
     }
@@ -198,13 +189,20 @@ void RenderSystem::m_render_map_tiles(const Camera& camera)
     {
       for (int i = first_chunk_position.x; i < camera_position.x + camera_size.x; i += world::chunk_size.y)
       {
-        const auto& chunk = m_world.chunk_manager.at(i, j, 0);
+        auto& chunk = m_world.chunk_manager.at(i, j, 0);
 
         if (chunk.tiles.height_map.empty())
         {
           continue;
         }
 
+        const auto* mesh = m_get_chunk_mesh(chunk);
+
+        if (mesh == nullptr)
+        {
+          continue;
+        }
+
         int lower_bound_j = 0;
         int upper_bound_j = world::chunk_size.z;
 
@@ -240,28 +238,7 @@ void RenderSystem::m_render_map_tiles(const Camera& camera)
               continue;
             }
 
-            for (int z = height; z >= 0; --z)
-            {
-              if (!chunk.tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, local_i, local_j, z)
-                  && !chunk.tiles.has_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, local_i, local_j, z))
-              {
-                continue;
-              }
-
-              const auto& cell = chunk.tiles.cell_at(local_i, local_j, z);
-              const Vector3i local_position{local_i, local_j, z};
-
-              if (chunk.tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, local_i, local_j, z))
-              {
-                m_render_map_tile(chunk, cell.top_face, local_position);
-                m_render_map_tile(chunk, cell.top_face_decoration, local_position, 1);
-              }
-              if (chunk.tiles.has_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, local_i, local_j, z))
-              {
-                m_render_map_tile(chunk, cell.front_face, local_position);
-                m_render_map_tile(chunk, cell.front_face_decoration, local_position, 1);
-              }
-            }
+            m_batch.mesh(*mesh, mesh->column_begin(local_i, local_j), mesh->column_end(local_i, local_j));
           }
         }
       }
@@ -269,48 +246,30 @@ void RenderSystem::m_render_map_tiles(const Camera& camera)
   }
 }
 
-void RenderSystem::m_render_map_tile(const Chunk& chunk,
-                                     const uint32_t tile_id,
-                                     const Vector3i& position,
-                                     const int z_index)
+void RenderSystem::build_chunk_meshes()
 {
-  if (tile_id <= 0)
+  for (auto& chunk : m_world.chunk_manager.chunks)
   {
-    return;
-  }
-
-  const auto& tile = m_tiles.at(tile_id);
-  const Vector3i world_position = chunk.position + position;
+    if (chunk->mesh != nullptr || chunk->tiles.height_map.empty())
+    {
+      continue;
+    }
 
-  // TODO: Add anchor and size to single type sprites so that we don't have to branch here
-  if (tile.frame_data->sprite_type == SpriteType::Single)
-  {
-    m_batch.tile(tile,
-                 world_position.x * m_tile_size.x,
-                 world_position.y * m_tile_size.y + z_index * m_z_index_increment,
-                 world_position.z * m_tile_size.y + z_index * m_z_index_increment,
-                 tile.frame_data->default_face);
-
-    // // TODO: Add neighbour chunk references to each chunk to be able to check tiles after the chunk bounds
-    // if (chunk.tiles.has_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, position.x, position.y, position.z))
-    // {
-    //   m_batch.tile(tile,
-    //                world_position.x * m_tile_size.x,
-    //                world_position.y * m_tile_size.y,
-    //                (world_position.z - 1) * m_tile_size.y,
-    //                DL_RENDER_FACE_FRONT);
-    // }
-  }
-  else if (tile.frame_data->sprite_type == SpriteType::Multiple)
-  {
-    m_batch.tile(tile,
-                 (world_position.x - tile.frame_data->anchor_x) * m_tile_size.x,
-                 (world_position.y - tile.frame_data->anchor_y) * m_tile_size.y,
-                 world_position.z * m_tile_size.y + z_index * m_z_index_increment,
-                 tile.frame_data->default_face);
+    auto mesh = m_chunk_mesher.build(*chunk);
+    m_batch.set_texture_index(*mesh);
+    chunk->mesh = std::move(mesh);
   }
 }
 
+const ChunkMesh* RenderSystem::m_get_chunk_mesh(const Chunk& chunk)
+{
+  // Meshes are built in the background when a chunk is first drawn or edited. Outdated meshes are drawn
+  // until the mesher replaces them and chunks without a mesh aren't drawn until theirs is ready.
+  // Chunks that aren't drawn aren't requested, they keep their outdated mesh until they are visible again.
+  m_chunk_mesher.request(chunk);
+  return chunk.mesh.get();
+}
+
 void RenderSystem::m_create_sprite(entt::registry& registry, entt::entity entity)
 {
   auto& sprite_data = registry.get<Sprite>(entity);
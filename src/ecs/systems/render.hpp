@@ -4,12 +4,14 @@
 #include <unordered_map>
 
 #include "ecs/components/tile.hpp"
+#include "graphics/chunk_mesher.hpp"
 
 namespace dl
 {
 class World;
 class Camera;
 struct Chunk;
+struct ChunkMesh;
 class Batch;
 class Renderer;
 struct GameContext;
@@ -21,6 +23,9 @@ class RenderSystem
  public:
   RenderSystem(GameContext& game_context, World& world);
   void render(entt::registry& registry, const Camera& camera);
+  // Builds the missing meshes of the loaded chunks in the calling thread. Used after loading
+  // the initial chunks so that the first frames aren't drawn without terrain.
+  void build_chunk_meshes();
 
  private:
   GameContext& m_game_context;
@@ -31,9 +36,10 @@ class RenderSystem
   std::unordered_map<uint32_t, Tile> m_tiles{};
   static constexpr int m_frustum_tile_padding = 1;
   static constexpr double m_z_index_increment = 0.02;
+  ChunkMesher m_chunk_mesher;
 
   void m_render_map_tiles(const Camera& camera);
-  void m_render_map_tile(const Chunk& chunk, const uint32_t tile_id, const Vector3i& position, const int z_index = 0);
+  const ChunkMesh* m_get_chunk_mesh(const Chunk& chunk);
 
   void m_create_sprite(entt::registry& registry, entt::entity entity);
 
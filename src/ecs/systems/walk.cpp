@@ -48,6 +48,27 @@ WalkSystem::WalkSystem(World& world, entt::registry& registry) : m_world(world)
 
 void WalkSystem::update(entt::registry& registry)
 {
+  // Assign the paths solved since the last turn
+  for (auto& result : m_pathfinding.collect())
+  {
+    if (!registry.valid(result.entity) || !registry.all_of<ActionWalk>(result.entity)
+        || registry.all_of<WalkPath>(result.entity))
+    {
+      continue;
+    }
+
+    // Discard the path if the target changed while it was being solved
+    const auto& action_walk = registry.get<ActionWalk>(result.entity);
+    if (!registry.valid(action_walk.job)
+        || static_cast<Vector3i>(registry.get<Target>(action_walk.job).position) != result.to)
+    {
+      continue;
+    }
+
+    auto& walk_path = registry.emplace<WalkPath>(result.entity);
+    walk_path.steps = std::move(result.steps);
+  }
+
   auto view = registry.view<ActionWalk, Movement, const Position>();
   for (const auto entity : view)
   {
@@ -81,16 +102,6 @@ void WalkSystem::update(entt::registry& registry)
       continue;
     }
 
-    if (!registry.all_of<WalkPath>(entity))
-    {
-      auto& walk_path = registry.emplace<WalkPath>(entity);
-      walk_path.steps
-          = m_world.find_path(Vector3i{std::round(position.x), std::round(position.y), std::round(position.z)},
-                              static_cast<Vector3i>(target.position));
-    }
-
-    auto& walk_path = registry.get<WalkPath>(entity);
-
     // If we got to the desired distance from the target, stop walking
     if (std::abs(target.position.x - position.x) <= target.distance_offset
         && std::abs(target.position.y - position.y) <= target.distance_offset)
@@ -99,6 +110,27 @@ void WalkSystem::update(entt::registry& registry)
       continue;
     }
 
+    if (!registry.all_of<WalkPath>(entity))
+    {
+      const auto from = Vector3i{std::round(position.x), std::round(position.y), std::round(position.z)};
+      const auto to = static_cast<Vector3i>(target.position);
+
+      // Adjacent targets don't need a search, everything else is solved in the background
+      if (std::abs(from.x - to.x) <= 1 && std::abs(from.y - to.y) <= 1 && std::abs(from.z - to.z) <= 1)
+      {
+        auto& walk_path = registry.emplace<WalkPath>(entity);
+        walk_path.steps = m_world.find_path(from, to);
+      }
+      else
+      {
+        // Keep the current movement until the path arrives
+        m_pathfinding.request(entity, from, to);
+        continue;
+      }
+    }
+
+    auto& walk_path = registry.get<WalkPath>(entity);
+
     // If there are no more steps in the path, stop walking
     if (walk_path.steps.empty())
     {
@@ -127,6 +159,8 @@ void WalkSystem::update(entt::registry& registry)
                                movement_component.direction.y = y_dir;
                              });
   }
+
+  m_pathfinding.dispatch();
 }
 
 }  // namespace dl
@@ -3,6 +3,7 @@
 #include <entt/entity/registry.hpp>
 
 #include "core/input_manager.hpp"
+#include "world/pathfinding_service.hpp"
 
 namespace dl
 {
@@ -15,8 +16,11 @@ class WalkSystem
 
   void update(entt::registry& registry);
 
+  [[nodiscard]] PathfindingService::Stats get_pathfinding_stats() const { return m_pathfinding.get_stats(); }
+
  private:
   World& m_world;
+  PathfindingService m_pathfinding{m_world};
   InputManager& m_input_manager = InputManager::get_instance();
 };
 }  // namespace dl
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <webgpu/wgpu.h>
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "graphics/renderer/quad_data.hpp"
+
+namespace dl
+{
+// Quads of the visible tiles of a chunk, built when the tiles change and added to the batch every frame
+struct ChunkMesh
+{
+  // Revision of the chunk the mesh was built from
+  uint32_t revision = 0;
+  int width = 0;
+  WGPUTextureView texture_view = nullptr;
+  // Texture index written to the quads, see Batch::set_texture_index()
+  float texture_index = 0.0f;
+  // Ordered by column
+  std::vector<QuadData> quads{};
+  // Index of the first quad of each column in row major order followed by the quad count
+  std::vector<uint32_t> column_offsets{};
+
+  uint32_t column_begin(const int x, const int y) const { return column_offsets[x + y * width]; }
+  uint32_t column_end(const int x, const int y) const { return column_offsets[x + y * width + 1]; }
+};
+}  // namespace dl
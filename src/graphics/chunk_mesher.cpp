@@ -0,0 +1,199 @@
+#include "./chunk_mesher.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include "config.hpp"
+#include "graphics/chunk_mesh.hpp"
+#include "graphics/frame_data.hpp"
+#include "graphics/renderer/batch.hpp"
+#include "graphics/renderer/spritesheet.hpp"
+#include "world/chunk.hpp"
+#include "world/chunk_manager.hpp"
+
+namespace dl
+{
+ChunkMesher::ChunkMesher(const std::unordered_map<uint32_t, Tile>& tiles,
+                         const Vector2i& tile_size,
+                         const double z_index_increment)
+    : m_tiles(tiles), m_tile_size(tile_size), m_z_index_increment(z_index_increment)
+{
+  m_max_jobs_in_flight = std::max(1u, config::world::chunk_meshing_jobs);
+  m_thread_pool.initialize(std::min(m_max_jobs_in_flight, std::max(1u, std::thread::hardware_concurrency())));
+}
+
+ChunkMesher::~ChunkMesher() { m_thread_pool.finalize(); }
+
+void ChunkMesher::request(const Chunk& chunk)
+{
+  if (chunk.mesh != nullptr && chunk.mesh->revision == chunk.revision)
+  {
+    return;
+  }
+
+  ++m_stale_count;
+
+  const auto key = ChunkManager::chunk_key(chunk.position);
+  const auto it = m_jobs_in_flight.find(key);
+
+  if (it != m_jobs_in_flight.end() || m_jobs_in_flight.size() >= m_max_jobs_in_flight)
+  {
+    // A job for an older revision is discarded when it finishes and requested again
+    return;
+  }
+
+  m_jobs_in_flight.emplace(key, chunk.revision);
+
+  // The job works on a copy since the chunk can be edited or unloaded while it runs. Only the
+  // visible cells are copied, the whole grid is too large to copy in the main thread.
+  const auto visible_cells = std::make_shared<const VisibleCells>(m_get_visible_cells(chunk.tiles));
+  const auto position = chunk.position;
+  const auto revision = chunk.revision;
+
+  m_thread_pool.queue_job(
+      [this, key, visible_cells, position, revision]
+      {
+        auto mesh = m_build(*visible_cells, position, revision);
+
+        const std::scoped_lock lock{m_finished_mutex};
+        m_finished.push_back(FinishedMesh{key, position, std::move(mesh)});
+      });
+}
+
+std::shared_ptr<ChunkMesh> ChunkMesher::build(const Chunk& chunk) const
+{
+  return m_build(m_get_visible_cells(chunk.tiles), chunk.position, chunk.revision);
+}
+
+void ChunkMesher::update(ChunkManager& chunk_manager, Batch& batch)
+{
+  m_stale_count = 0;
+
+  std::vector<FinishedMesh> finished{};
+
+  {
+    const std::scoped_lock lock{m_finished_mutex};
+    finished.swap(m_finished);
+  }
+
+  for (auto& finished_mesh : finished)
+  {
+    m_jobs_in_flight.erase(finished_mesh.key);
+
+    auto& chunk = chunk_manager.at(finished_mesh.position);
+
+    // Revisions are unique, this also discards meshes of chunks that were unloaded
+    if (chunk.revision != finished_mesh.mesh->revision)
+    {
+      continue;
+    }
+
+    batch.set_texture_index(*finished_mesh.mesh);
+    chunk.mesh = std::move(finished_mesh.mesh);
+  }
+}
+
+ChunkMesher::VisibleCells ChunkMesher::m_get_visible_cells(const Grid3D& tiles)
+{
+  VisibleCells visible_cells{};
+  visible_cells.width = tiles.size.x;
+  visible_cells.height = tiles.size.y;
+  visible_cells.column_offsets.reserve(tiles.size.x * tiles.size.y + 1);
+
+  for (int local_j = 0; local_j < tiles.size.y; ++local_j)
+  {
+    for (int local_i = 0; local_i < tiles.size.x; ++local_i)
+    {
+      visible_cells.column_offsets.push_back(visible_cells.cells.size());
+
+      // Only the levels with a visible face are visited instead of every cell below the height
+      tiles.for_each_visible_level(
+          local_i,
+          local_j,
+          [&tiles, &visible_cells, local_i, local_j](
+              const int z, const bool is_top_face_visible, const bool is_front_face_visible) {
+            visible_cells.cells.push_back(
+                VisibleCell{z, is_top_face_visible, is_front_face_visible, tiles.cell_at(local_i, local_j, z)});
+          });
+    }
+  }
+
+  visible_cells.column_offsets.push_back(visible_cells.cells.size());
+
+  return visible_cells;
+}
+
+std::shared_ptr<ChunkMesh> ChunkMesher::m_build(const VisibleCells& visible_cells,
+                                                const Vector3i& position,
+                                                const uint32_t revision) const
+{
+  auto mesh = std::make_shared<ChunkMesh>();
+  mesh->revision = revision;
+  mesh->width = visible_cells.width;
+  mesh->column_offsets.reserve(visible_cells.column_offsets.size());
+
+  for (int local_j = 0; local_j < visible_cells.height; ++local_j)
+  {
+    for (int local_i = 0; local_i < visible_cells.width; ++local_i)
+    {
+      const int column = local_i + local_j * visible_cells.width;
+      mesh->column_offsets.push_back(mesh->quads.size());
+
+      for (uint32_t i = visible_cells.column_offsets[column]; i < visible_cells.column_offsets[column + 1]; ++i)
+      {
+        const auto& visible_cell = visible_cells.cells[i];
+        const auto& cell = visible_cell.cell;
+        const Vector3i world_position = position + Vector3i{local_i, local_j, visible_cell.z};
+
+        if (visible_cell.is_top_face_visible)
+        {
+          m_add_tile(*mesh, cell.top_face, world_position);
+          m_add_tile(*mesh, cell.top_face_decoration, world_position, 1);
+        }
+        if (visible_cell.is_front_face_visible)
+        {
+          m_add_tile(*mesh, cell.front_face, world_position);
+          m_add_tile(*mesh, cell.front_face_decoration, world_position, 1);
+        }
+      }
+    }
+  }
+
+  mesh->column_offsets.push_back(mesh->quads.size());
+
+  return mesh;
+}
+
+void ChunkMesher::m_add_tile(ChunkMesh& mesh,
+                             const uint32_t tile_id,
+                             const Vector3i& world_position,
+                             const int z_index) const
+{
+  if (tile_id <= 0)
+  {
+    return;
+  }
+
+  const auto& tile = m_tiles.at(tile_id);
+
+  // TODO: Add anchor and size to single type sprites so that we don't have to branch here
+  if (tile.frame_data->sprite_type == SpriteType::Single)
+  {
+    Batch::tile(mesh,
+                tile,
+                world_position.x * m_tile_size.x,
+                world_position.y * m_tile_size.y + z_index * m_z_index_increment,
+                world_position.z * m_tile_size.y + z_index * m_z_index_increment,
+                tile.frame_data->default_face);
+  }
+  else if (tile.frame_data->sprite_type == SpriteType::Multiple)
+  {
+    Batch::tile(mesh,
+                tile,
+                (world_position.x - tile.frame_data->anchor_x) * m_tile_size.x,
+                (world_position.y - tile.frame_data->anchor_y) * m_tile_size.y,
+                world_position.z * m_tile_size.y + z_index * m_z_index_increment,
+                tile.frame_data->default_face);
+  }
+}
+}  // namespace dl
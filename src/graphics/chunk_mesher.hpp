@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/maths/vector.hpp"
+#include "core/thread_pool.hpp"
+#include "ecs/components/tile.hpp"
+#include "world/cell.hpp"
+
+namespace dl
+{
+struct Chunk;
+struct ChunkMesh;
+class ChunkManager;
+class Batch;
+class Grid3D;
+
+// Builds the tile meshes of the chunks in background threads. A chunk keeps drawing its
+// previous mesh, or nothing if it has none yet, until the new one is ready and replaces it in update().
+class ChunkMesher
+{
+ public:
+  ChunkMesher(const std::unordered_map<uint32_t, Tile>& tiles,
+              const Vector2i& tile_size,
+              const double z_index_increment);
+  ~ChunkMesher();
+
+  ChunkMesher(const ChunkMesher&) = delete;
+  ChunkMesher& operator=(const ChunkMesher&) = delete;
+
+  // Queues a job if the chunk mesh is missing or outdated and there is room for another job,
+  // only the visible cells of the chunk are copied for the job
+  void request(const Chunk& chunk);
+  // Builds a chunk mesh in the calling thread, for when a chunk can't wait for a job
+  std::shared_ptr<ChunkMesh> build(const Chunk& chunk) const;
+  // Gives the finished meshes to their chunks, discarding the ones built from tiles that changed since
+  void update(ChunkManager& chunk_manager, Batch& batch);
+
+  int get_jobs_in_flight() const { return static_cast<int>(m_jobs_in_flight.size()); }
+  // Requests since the last update for chunks with a missing or outdated mesh
+  int get_stale_count() const { return m_stale_count; }
+
+ private:
+  struct VisibleCell
+  {
+    int z = 0;
+    bool is_top_face_visible = false;
+    bool is_front_face_visible = false;
+    Cell cell{};
+  };
+
+  // Visible cells of a chunk ordered by column, a mesh is built from them
+  struct VisibleCells
+  {
+    int width = 0;
+    int height = 0;
+    // Index of the first cell of each column in row major order followed by the cell count
+    std::vector<uint32_t> column_offsets{};
+    std::vector<VisibleCell> cells{};
+  };
+
+  struct FinishedMesh
+  {
+    uint64_t key = 0;
+    Vector3i position{};
+    std::shared_ptr<ChunkMesh> mesh = nullptr;
+  };
+
+  const std::unordered_map<uint32_t, Tile>& m_tiles;
+  const Vector2i& m_tile_size;
+  const double m_z_index_increment;
+  ThreadPool m_thread_pool{};
+  uint32_t m_max_jobs_in_flight = 1;
+  // Revision being built for each chunk key
+  std::unordered_map<uint64_t, uint32_t> m_jobs_in_flight{};
+  std::mutex m_finished_mutex{};
+  std::vector<FinishedMesh> m_finished{};
+  int m_stale_count = 0;
+
+  static VisibleCells m_get_visible_cells(const Grid3D& tiles);
+  std::shared_ptr<ChunkMesh> m_build(const VisibleCells& visible_cells,
+                                     const Vector3i& position,
+                                     const uint32_t revision) const;
+  void m_add_tile(ChunkMesh& mesh,
+                  const uint32_t tile_id,
+                  const Vector3i& world_position,
+                  const int z_index = 0) const;
+};
+}  // namespace dl
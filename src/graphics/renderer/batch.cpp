@@ -2,19 +2,21 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
 #include "core/asset_manager.hpp"
 #include "core/game_context.hpp"
 #include "ecs/components/sprite.hpp"
 #include "ecs/components/texture_slice.hpp"
 #include "ecs/components/tile.hpp"
 #include "graphics/camera.hpp"
+#include "graphics/chunk_mesh.hpp"
 #include "graphics/color.hpp"
 #include "graphics/display.hpp"
 #include "graphics/nine_patch.hpp"
 #include "graphics/quad.hpp"
 #include "graphics/render_face.hpp"
 #include "graphics/renderer/spritesheet.hpp"
-#include "graphics/renderer/utils.hpp"
 #include "graphics/text.hpp"
 
 namespace dl
@@ -34,10 +36,9 @@ void Batch::load()
 
 void Batch::m_load_batch_data()
 {
-  // Add main vertex buffer
-  batch_data.emplace_back(m_context.device, MAIN_BATCH_VERTEX_COUNT, MAIN_BATCH_INDEX_COUNT);
-  m_current_vb = &batch_data[0];
-  utils::populate_quad_index_buffer(m_context.queue, m_current_vb->index_buffer, MAIN_BATCH_INDEX_COUNT);
+  // Add main vertex buffer, it's always the first one of the pool
+  m_current_vb = m_acquire_buffer(MAIN_BATCH_QUAD_COUNT);
+  m_main_vb = m_current_vb;
 }
 
 void Batch::m_load_textures()
@@ -55,9 +56,9 @@ void Batch::m_load_textures()
 
 bool Batch::empty()
 {
-  for (const auto& batch_datum : batch_data)
+  for (const auto* batch_datum : batch_data)
   {
-    if (batch_datum.index_buffer_count > 0)
+    if (batch_datum->instance_count > 0)
     {
       return false;
     }
@@ -66,6 +67,43 @@ bool Batch::empty()
   return true;
 }
 
+void Batch::reset()
+{
+  m_stats = BatchStats{};
+
+  for (auto& buffer : m_buffers)
+  {
+    ++buffer->idle_frame_count;
+  }
+
+  for (auto* batch_datum : batch_data)
+  {
+    if (batch_datum->instance_count > 0)
+    {
+      m_stats.quad_count += batch_datum->instance_count;
+      m_stats.uploaded_bytes += batch_datum->vertex_buffer_size;
+      ++m_stats.buffer_count;
+    }
+
+    batch_datum->reset();
+    batch_datum->is_acquired = false;
+    batch_datum->idle_frame_count = 0;
+  }
+
+  batch_data.clear();
+
+  // Shrink the pool after a peak, the main buffer is always kept
+  const auto* main_buffer = m_buffers[0].get();
+  std::erase_if(m_buffers, [main_buffer](const auto& buffer) {
+    return buffer.get() != main_buffer && buffer->idle_frame_count >= MAX_IDLE_FRAMES;
+  });
+
+  m_stats.pooled_buffer_count = m_buffers.size();
+
+  m_current_vb = m_acquire_buffer(MAIN_BATCH_QUAD_COUNT);
+  m_main_vb = m_current_vb;
+}
+
 void Batch::clear_textures()
 {
   m_texture_slot_index = m_texture_slot_index_base;
@@ -131,19 +169,7 @@ void Batch::texture_slice(TextureSlice& slice, const double x, const double y, c
 
   const float texture_index = m_get_texture_index(slice.texture->view);
 
-  // Top left vertex
-  m_current_vb->emplace(glm::vec3{x, y, z}, uv_coordinates[0], texture_index, color);
-
-  // Top right vertex
-  m_current_vb->emplace(glm::vec3{x + size.x, y, z}, uv_coordinates[1], texture_index, color);
-
-  // Bottom left vertex
-  m_current_vb->emplace(glm::vec3{x, y + size.y, z}, uv_coordinates[3], texture_index, color);
-
-  // Bottom right vertex
-  m_current_vb->emplace(glm::vec3{x + size.x, y + size.y, z}, uv_coordinates[2], texture_index, color);
-
-  m_current_vb->index_buffer_count += 6;
+  m_emplace_quad(encode_quad(glm::vec3{x, y, z}, size, uv_coordinates, texture_index, color));
 }
 
 void Batch::tile(const Tile& tile, const double x, const double y, const double z, const RenderFace face)
@@ -165,30 +191,101 @@ void Batch::tile(const Tile& tile, const double x, const double y, const double
   m_emplace_sprite_face(std::move(data));
 }
 
+void Batch::tile(
+    ChunkMesh& mesh, const Tile& tile, const double x, const double y, const double z, const RenderFace face)
+{
+  assert(tile.spritesheet != nullptr);
+  assert(tile.frame_data != nullptr);
+  assert(tile.size.x != 0);
+  assert(tile.size.y != 0);
+  assert((mesh.texture_view == nullptr || mesh.texture_view == tile.spritesheet->texture->view)
+         && "All the tiles of a mesh must share the same texture");
+
+  const auto& size = tile.size;
+  const uint32_t color = 0xFFFFFFFF;
+  const auto& uv_coordinates = tile.spritesheet->get_uv_coordinates(tile.frame_data->faces[face]);
+
+  mesh.texture_view = tile.spritesheet->texture->view;
+
+  if (!m_is_face_supported(face))
+  {
+    return;
+  }
+
+  mesh.quads.push_back(encode_quad(glm::vec3{x, y, z}, size, uv_coordinates, mesh.texture_index, color, face));
+}
+
+void Batch::set_texture_index(ChunkMesh& mesh)
+{
+  const float texture_index = m_get_texture_index(mesh.texture_view);
+
+  if (texture_index == mesh.texture_index)
+  {
+    return;
+  }
+
+  for (auto& quad : mesh.quads)
+  {
+    quad.texture_id = encode_texture_id(texture_index);
+  }
+
+  mesh.texture_index = texture_index;
+}
+
+void Batch::mesh(const ChunkMesh& mesh, uint32_t begin, const uint32_t end)
+{
+  assert(m_current_vb != nullptr);
+  assert(begin <= end && end <= mesh.quads.size());
+
+  if (begin == end)
+  {
+    return;
+  }
+
+  // The texture may be bound to another slot since the mesh was built
+  const float texture_index = m_get_texture_index(mesh.texture_view);
+
+  // Ranges that don't fit in the current buffer continue in the next ones
+  while (begin < end)
+  {
+    if (!m_current_vb->has_space(1))
+    {
+      m_roll_over();
+    }
+
+    const uint32_t count = std::min(end - begin, m_current_vb->max_instance_count - m_current_vb->instance_count);
+    m_current_vb->reserve(count);
+
+    auto* quads = &m_current_vb->instances[m_current_vb->instance_count];
+    std::copy(mesh.quads.begin() + begin, mesh.quads.begin() + begin + count, quads);
+
+    if (texture_index != mesh.texture_index)
+    {
+      for (uint32_t i = 0; i < count; ++i)
+      {
+        quads[i].texture_id = encode_texture_id(texture_index);
+      }
+    }
+
+    m_current_vb->instance_count += count;
+    begin += count;
+  }
+}
+
 void Batch::texture(const Texture& texture, const double x, const double y, const double z)
 {
   assert(m_current_vb != nullptr);
   assert(texture.size.x != 0);
   assert(texture.size.y != 0);
 
-  const auto& size = texture.size;
+  const glm::vec2 size{static_cast<float>(texture.size.x), static_cast<float>(texture.size.y)};
   const uint32_t color = 0xFFFFFFFF;
+  const std::array<glm::vec2, 4> uv_coordinates{
+      glm::vec2{0.0f, 0.0f}, glm::vec2{1.0f, 0.0f}, glm::vec2{1.0f, 1.0f}, glm::vec2{0.0f, 1.0f}};
 
   const float texture_index = m_get_texture_index(texture.view);
 
-  // Top left vertex
-  m_current_vb->emplace(glm::vec3{x, y, z}, glm::vec2{0.0f, 0.0f}, texture_index, color);
-
-  // Top right vertex
-  m_current_vb->emplace(glm::vec3{x + size.x, y, z}, glm::vec2{1.0f, 0.0f}, texture_index, color);
-
-  // Bottom left vertex
-  m_current_vb->emplace(glm::vec3{x, y + size.y, z}, glm::vec2{0.0f, 1.0f}, texture_index, color);
-
-  // Bottom right vertex
-  m_current_vb->emplace(glm::vec3{x + size.x, y + size.y, z}, glm::vec2{1.0f, 1.0f}, texture_index, color);
-
-  m_current_vb->index_buffer_count += 6;
+  m_emplace_quad(encode_quad(glm::vec3{x, y, z}, size, uv_coordinates, texture_index, color));
 }
 
 void Batch::quad(const Quad& quad, const double x, const double y, const double z)
@@ -204,19 +301,11 @@ void Batch::quad(const Quad& quad, const double x, const double y, const double
         quad_color.r, quad_color.g, quad_color.b, static_cast<uint8_t>(quad_color.a * quad.color.opacity_factor));
   }
 
-  // Top left vertex
-  m_current_vb->emplace(glm::vec3{x, y, z}, glm::vec2{0}, -1.0f, color);
-
-  // Top right vertex
-  m_current_vb->emplace(glm::vec3{x + quad.w, y, z}, glm::vec2{0}, -1.0f, color);
+  const std::array<glm::vec2, 4> uv_coordinates{};
 
-  // Bottom left vertex
-  m_current_vb->emplace(glm::vec3{x, y + quad.h, z}, glm::vec2{0}, -1.0f, color);
+  const glm::vec2 size{static_cast<float>(quad.w), static_cast<float>(quad.h)};
 
-  // Bottom right vertex
-  m_current_vb->emplace(glm::vec3{x + quad.w, y + quad.h, z}, glm::vec2{0}, -1.0f, color);
-
-  m_current_vb->index_buffer_count += 6;
+  m_emplace_quad(encode_quad(glm::vec3{x, y, z}, size, uv_coordinates, -1.0f, color));
 }
 
 void Batch::text(Text& text, const double x, const double y, const double z)
@@ -310,183 +399,95 @@ void Batch::push_scissor(Vector4i scissor)
     scissor.w *= scale.x;
   }
 
+  m_current_vb = m_acquire_buffer(SECONDARY_BATCH_QUAD_COUNT);
+  m_current_vb->scissor = std::move(scissor);
+}
+
+void Batch::pop_scissor()
+{
+  m_current_vb = m_main_vb;
+}
+
+BatchData<QuadData>* Batch::m_acquire_buffer(const uint32_t max_quad_count)
+{
+  BatchData<QuadData>* buffer = nullptr;
+
   // Try to reuse a vertex buffer
-  if (batch_data.size() > 1)
+  for (auto& pooled_buffer : m_buffers)
   {
-    for (auto& batch_datum : batch_data)
+    if (!pooled_buffer->is_acquired && pooled_buffer->max_instance_count == max_quad_count)
     {
-      if (batch_datum.index_buffer_count == 0)
-      {
-        batch_datum.scissor = std::move(scissor);
-        m_current_vb = &batch_datum;
-        return;
-      }
+      buffer = pooled_buffer.get();
+      break;
     }
   }
 
   // Create a new buffer
-  BatchData<VertexData> batch_datum{m_context.device, SECONDARY_BATCH_VERTEX_COUNT, SECONDARY_BATCH_INDEX_COUNT};
-  batch_datum.scissor = std::move(scissor);
-  batch_data.push_back(std::move(batch_datum));
-  m_current_vb = &batch_data.back();
-  utils::populate_quad_index_buffer(m_context.queue, m_current_vb->index_buffer, SECONDARY_BATCH_INDEX_COUNT);
-}
+  if (buffer == nullptr)
+  {
+    m_buffers.push_back(std::make_unique<BatchData<QuadData>>(m_context.device, max_quad_count));
+    buffer = m_buffers.back().get();
+  }
 
-void Batch::pop_scissor()
-{
-  m_current_vb = &batch_data[0];
+  buffer->is_acquired = true;
+  batch_data.push_back(buffer);
+
+  return buffer;
 }
 
-void Batch::m_emplace_sprite_face(const SpriteBatchData data)
+void Batch::m_roll_over()
 {
-  switch (data.face)
+  auto* buffer = m_acquire_buffer(m_current_vb->max_instance_count);
+  buffer->scissor = m_current_vb->scissor;
+
+  // Buffers without a scissor are drawn before the scissored ones, which set their own scissor rect
+  if (m_current_vb == m_main_vb)
   {
-  case DL_RENDER_FACE_TOP:
-    m_emplace_sprite_face_top(std::move(data));
-    break;
-  case DL_RENDER_FACE_FRONT:
-    m_emplace_sprite_face_front(std::move(data));
-    break;
-  case DL_RENDER_FACE_BOTTOM:
-    m_emplace_sprite_face_bottom(std::move(data));
-    break;
-  case DL_RENDER_FACE_TOP_FRONT:
-    m_emplace_sprite_face_top_front(std::move(data));
-    break;
-  case DL_RENDER_FACE_LEFT:
-    // TODO
-    break;
-  case DL_RENDER_FACE_RIGHT:
-    // TODO
-    break;
-  case DL_RENDER_FACE_BACK:
-    // TODO
-    break;
-  case DL_RENDER_FACE_CENTER_HORIZONTAL:
-    // TODO
-    break;
-  case DL_RENDER_FACE_CENTER_VERTICAL:
-    // TODO
-    break;
-  default:
-    break;
+    const auto main_it = std::find(batch_data.begin(), batch_data.end(), m_main_vb);
+    std::rotate(main_it + 1, batch_data.end() - 1, batch_data.end());
+    m_main_vb = buffer;
   }
-}
 
-void Batch::m_emplace_sprite_face_bottom(const SpriteBatchData data)
-{
-  // Top left vertex
-  m_current_vb->emplace(glm::vec3{data.position.x, data.position.y, data.position.z - data.size.y},
-                        data.texture_coordinates[0],
-                        data.texture_index,
-                        data.color);
-
-  // Top right vertex
-  m_current_vb->emplace(glm::vec3{data.position.x + data.size.x, data.position.y, data.position.z - data.size.y},
-                        data.texture_coordinates[1],
-                        data.texture_index,
-                        data.color);
-
-  // Bottom left vertex
-  m_current_vb->emplace(glm::vec3{data.position.x, data.position.y + data.size.y, data.position.z - data.size.y},
-                        data.texture_coordinates[3],
-                        data.texture_index,
-                        data.color);
-
-  // Bottom right vertex
-  m_current_vb->emplace(
-      glm::vec3{data.position.x + data.size.x, data.position.y + data.size.y, data.position.z - data.size.y},
-      data.texture_coordinates[2],
-      data.texture_index,
-      data.color);
-
-  m_current_vb->index_buffer_count += 6;
+  m_current_vb = buffer;
 }
 
-void Batch::m_emplace_sprite_face_top(const SpriteBatchData data)
+void Batch::m_emplace_quad(const QuadData& quad)
 {
-  // Top left vertex
-  m_current_vb->emplace(data.position, data.texture_coordinates[0], data.texture_index, data.color);
-
-  // Top right vertex
-  m_current_vb->emplace(glm::vec3{data.position.x + data.size.x, data.position.y, data.position.z},
-                        data.texture_coordinates[1],
-                        data.texture_index,
-                        data.color);
-
-  // Bottom left vertex
-  m_current_vb->emplace(glm::vec3{data.position.x, data.position.y + data.size.y, data.position.z},
-                        data.texture_coordinates[3],
-                        data.texture_index,
-                        data.color);
-
-  // Bottom right vertex
-  m_current_vb->emplace(glm::vec3{data.position.x + data.size.x, data.position.y + data.size.y, data.position.z},
-                        data.texture_coordinates[2],
-                        data.texture_index,
-                        data.color);
-
-  m_current_vb->index_buffer_count += 6;
+  assert(m_current_vb != nullptr);
+
+  if (!m_current_vb->has_space(1))
+  {
+    m_roll_over();
+  }
+
+  m_current_vb->reserve(1);
+  m_current_vb->emplace(quad);
 }
 
-void Batch::m_emplace_sprite_face_front(const SpriteBatchData data)
+void Batch::m_emplace_sprite_face(const SpriteBatchData data)
 {
-  // Top left vertex
-  m_current_vb->emplace(glm::vec3{data.position.x, data.position.y + data.size.y, data.position.z},
-                        data.texture_coordinates[0],
-                        data.texture_index,
-                        data.color);
-
-  // Top right vertex
-  m_current_vb->emplace(glm::vec3{data.position.x + data.size.x, data.position.y + data.size.y, data.position.z},
-                        data.texture_coordinates[1],
-                        data.texture_index,
-                        data.color);
-
-  // Bottom left vertex
-  m_current_vb->emplace(glm::vec3{data.position.x, data.position.y + data.size.y, data.position.z - data.size.y},
-                        data.texture_coordinates[3],
-                        data.texture_index,
-                        data.color);
-
-  // Bottom right vertex
-  m_current_vb->emplace(
-      glm::vec3{data.position.x + data.size.x, data.position.y + data.size.y, data.position.z - data.size.y},
-      data.texture_coordinates[2],
-      data.texture_index,
-      data.color);
-
-  m_current_vb->index_buffer_count += 6;
+  if (!m_is_face_supported(data.face))
+  {
+    return;
+  }
+
+  m_emplace_quad(
+      encode_quad(data.position, data.size, data.texture_coordinates, data.texture_index, data.color, data.face));
 }
 
-void Batch::m_emplace_sprite_face_top_front(const SpriteBatchData data)
+bool Batch::m_is_face_supported(const RenderFace face)
 {
-  // Top left vertex
-  m_current_vb->emplace(glm::vec3{data.position.x, data.position.y + data.size.y, data.position.z + data.size.y},
-                        data.texture_coordinates[0],
-                        data.texture_index,
-                        data.color);
-
-  // Top right vertex
-  m_current_vb->emplace(
-      glm::vec3{data.position.x + data.size.x, data.position.y + data.size.y, data.position.z + data.size.y},
-      data.texture_coordinates[1],
-      data.texture_index,
-      data.color);
-
-  // Bottom left vertex
-  m_current_vb->emplace(glm::vec3{data.position.x, data.position.y + data.size.y, data.position.z},
-                        data.texture_coordinates[3],
-                        data.texture_index,
-                        data.color);
-
-  // Bottom right vertex
-  m_current_vb->emplace(glm::vec3{data.position.x + data.size.x, data.position.y + data.size.y, data.position.z},
-                        data.texture_coordinates[2],
-                        data.texture_index,
-                        data.color);
-
-  m_current_vb->index_buffer_count += 6;
+  switch (face)
+  {
+  case DL_RENDER_FACE_TOP:
+  case DL_RENDER_FACE_FRONT:
+  case DL_RENDER_FACE_BOTTOM:
+  case DL_RENDER_FACE_TOP_FRONT:
+    return true;
+  // TODO: Expand the other faces in the shaders
+  default:
+    return false;
+  }
 }
 
 // Build vector of textures to bind when rendering
@@ -8,14 +8,15 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <memory>
 #include <vector>
 
 #include "core/maths/vector.hpp"
 #include "graphics/render_face.hpp"
 #include "graphics/renderer/batch_data.hpp"
+#include "graphics/renderer/quad_data.hpp"
 #include "graphics/renderer/shader.hpp"
 #include "graphics/renderer/texture.hpp"
-#include "graphics/renderer/vertex_data.hpp"
 #include "graphics/renderer/wgpu_context.hpp"
 
 namespace dl
@@ -27,6 +28,7 @@ class Text;
 struct NinePatch;
 struct Tile;
 struct Sprite;
+struct ChunkMesh;
 struct TextureSlice;
 
 struct UniformData
@@ -50,21 +52,32 @@ struct Pipeline
   bool has_depth_test = true;
 };
 
+// Statistics of the last rendered frame
+struct BatchStats
+{
+  uint32_t quad_count = 0;
+  // Buffers with quads, each one is a draw call
+  uint32_t buffer_count = 0;
+  // Buffers kept in the pool, including the ones that weren't used
+  uint32_t pooled_buffer_count = 0;
+  std::size_t uploaded_bytes = 0;
+};
+
 class Batch
 {
  public:
-  static constexpr uint32_t MAIN_BATCH_QUAD_COUNT = 80000;
-  static constexpr uint32_t MAIN_BATCH_INDEX_COUNT = MAIN_BATCH_QUAD_COUNT * 6;
-  static constexpr uint32_t MAIN_BATCH_VERTEX_COUNT = MAIN_BATCH_QUAD_COUNT * 4;
-
+  // Size of each vertex buffer, a batch rolls over to another buffer from its pool when one is full
+  static constexpr uint32_t MAIN_BATCH_QUAD_COUNT = 20000;
   static constexpr uint32_t SECONDARY_BATCH_QUAD_COUNT = 500;
-  static constexpr uint32_t SECONDARY_BATCH_INDEX_COUNT = SECONDARY_BATCH_QUAD_COUNT * 6;
-  static constexpr uint32_t SECONDARY_BATCH_VERTEX_COUNT = SECONDARY_BATCH_QUAD_COUNT * 4;
 
   static constexpr uint32_t TEXTURE_SLOTS = 8;
 
+  // Pooled buffers that stay unused for this number of frames are released
+  static constexpr uint32_t MAX_IDLE_FRAMES = 300;
+
   Pipeline pipeline{};
-  std::vector<BatchData<VertexData>> batch_data{};
+  // Buffers used in the current frame in the order they are drawn, the ones without a scissor come first
+  std::vector<BatchData<QuadData>*> batch_data{};
   std::array<WGPUTextureView, TEXTURE_SLOTS> texture_views{};
   bool should_update_texture_bind_group = false;
 
@@ -75,6 +88,10 @@ class Batch
   // Returns true if all the vertex buffers are empty
   bool empty();
 
+  // Releases the buffers of the frame after it was rendered and updates the statistics
+  void reset();
+  const BatchStats& get_stats() const { return m_stats; }
+
   // Clear non pinned textures
   void clear_textures();
 
@@ -84,6 +101,15 @@ class Batch
   void sprite(Sprite& sprite, double x, double y, double z, RenderFace face = DL_RENDER_FACE_TOP);
   void texture_slice(TextureSlice& slice, double x, double y, double z);
   void tile(const Tile& tile, double x, double y, double z, RenderFace face = DL_RENDER_FACE_TOP);
+  // Writes the tile quad to a mesh, the mesh can then be added every frame with mesh(). It doesn't
+  // use the batch state so meshes can be built in other threads, set_texture_index() must be called
+  // before the mesh is added.
+  static void tile(
+      ChunkMesh& mesh, const Tile& tile, double x, double y, double z, RenderFace face = DL_RENDER_FACE_TOP);
+  // Writes the slot of the mesh texture in this batch to the mesh quads
+  void set_texture_index(ChunkMesh& mesh);
+  // Adds the mesh quads in [begin, end)
+  void mesh(const ChunkMesh& mesh, const uint32_t begin, const uint32_t end);
   void texture(const Texture& texture, double x, double y, double z);
   void quad(const Quad& quad, double x, double y, double z);
   void text(Text& text, double x, double y, double z);
@@ -105,7 +131,11 @@ class Batch
 
   GameContext& m_game_context;
   WGPUContext& m_context;
-  BatchData<VertexData>* m_current_vb = nullptr;
+  std::vector<std::unique_ptr<BatchData<QuadData>>> m_buffers{};
+  BatchData<QuadData>* m_current_vb = nullptr;
+  // Last buffer without a scissor, restored when a scissor is popped
+  BatchData<QuadData>* m_main_vb = nullptr;
+  BatchStats m_stats{};
 
   Texture m_dummy_texture;
   uint32_t m_texture_slot_index_base = 0;
@@ -113,11 +143,16 @@ class Batch
 
   void m_load_batch_data();
   void m_load_textures();
+  // Returns a free buffer of the pool with the given size, creating it if needed
+  BatchData<QuadData>* m_acquire_buffer(const uint32_t max_quad_count);
+  // Continues the current buffer in a new one with the same size and scissor
+  void m_roll_over();
+  // Adds a quad to the current buffer
+  void m_emplace_quad(const QuadData& quad);
   void m_emplace_sprite_face(SpriteBatchData data);
-  void m_emplace_sprite_face_top(SpriteBatchData data);
-  void m_emplace_sprite_face_front(SpriteBatchData data);
-  void m_emplace_sprite_face_bottom(SpriteBatchData data);
-  void m_emplace_sprite_face_top_front(SpriteBatchData data);
+
+  // Returns false if the shaders can't expand a quad to the face
+  static bool m_is_face_supported(const RenderFace face);
 
   // Build vector of textures to bind when rendering
   // texture_index is the index in texture_views that will
@@ -2,58 +2,43 @@
 
 #include <webgpu/wgpu.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "core/maths/vector.hpp"
 
 namespace dl
 {
+// Buffer of instances, each one is drawn as a quad
 template <typename T>
 struct BatchData
 {
   WGPUBuffer vertex_buffer;
-  WGPUBuffer index_buffer;
-  uint32_t vertex_buffer_count = 0;
-  uint32_t index_buffer_count = 0;
-  uint32_t max_vertex_size = 0;
-  uint32_t max_index_size = 0;
+  uint32_t instance_count = 0;
+  uint32_t max_instance_count = 0;
   uint32_t vertex_buffer_size = 0;
-  uint32_t index_buffer_size = 0;
-  std::vector<T> vertices{};
-  std::vector<uint32_t> indices{};
+  std::vector<T> instances{};
   Vector4i scissor{0, 0, -1, -1};
+  // Pool state, set while the buffer is used in the current frame
+  bool is_acquired = false;
+  uint32_t idle_frame_count = 0;
 
   // Constructor
-  BatchData(WGPUDevice device, const uint32_t max_vertex_size, const uint32_t max_index_size)
-      : max_vertex_size(max_vertex_size), max_index_size(max_index_size)
+  BatchData(WGPUDevice device, const uint32_t max_instance_count) : max_instance_count(max_instance_count)
   {
-    // Create vertex buffer
-    vertices.resize(max_vertex_size);
+    // Create vertex buffer, the instances grow as they are needed
     WGPUBufferDescriptor buffer_descriptor = {
         .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex,
-        .size = max_vertex_size * sizeof(T),
+        .size = max_instance_count * sizeof(T),
         .mappedAtCreation = false,
     };
     vertex_buffer = wgpuDeviceCreateBuffer(device, &buffer_descriptor);
     assert(vertex_buffer != nullptr);
-
-    // Create index buffer
-    indices.resize(max_index_size);
-    WGPUBufferDescriptor index_buffer_descriptor = {
-        .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Index,
-        .size = max_index_size * sizeof(uint32_t),
-        .mappedAtCreation = false,
-    };
-    index_buffer = wgpuDeviceCreateBuffer(device, &index_buffer_descriptor);
-    assert(index_buffer != nullptr);
   }
 
   // Destructor
   ~BatchData()
   {
-    if (index_buffer != nullptr)
-    {
-      wgpuBufferDestroy(index_buffer);
-      wgpuBufferRelease(index_buffer);
-    }
     if (vertex_buffer != nullptr)
     {
       wgpuBufferDestroy(vertex_buffer);
@@ -66,68 +51,69 @@ struct BatchData
   BatchData(const BatchData& rhs) = delete;
 
   // Move assignment operator and move constructor
-  BatchData&& operator=(BatchData&& rhs) noexcept
+  BatchData& operator=(BatchData&& rhs) noexcept
   {
     vertex_buffer = rhs.vertex_buffer;
-    vertex_buffer_count = rhs.vertex_buffer_count;
+    instance_count = rhs.instance_count;
+    max_instance_count = rhs.max_instance_count;
     vertex_buffer_size = rhs.vertex_buffer_size;
-    index_buffer = rhs.index_buffer;
-    index_buffer_count = rhs.index_buffer_count;
-    index_buffer_size = rhs.index_buffer_size;
-    max_vertex_size = rhs.max_vertex_size;
-    max_index_size = rhs.max_index_size;
-    vertices = std::move(rhs.vertices);
+    instances = std::move(rhs.instances);
     scissor = std::move(rhs.scissor);
 
     rhs.vertex_buffer = nullptr;
-    rhs.index_buffer = nullptr;
-    rhs.vertex_buffer_count = 0;
+    rhs.instance_count = 0;
     rhs.vertex_buffer_size = 0;
-    rhs.index_buffer_count = 0;
-    rhs.index_buffer_size = 0;
+
+    return *this;
   }
 
   BatchData(BatchData&& rhs) noexcept
   {
     vertex_buffer = rhs.vertex_buffer;
-    vertex_buffer_count = rhs.vertex_buffer_count;
+    instance_count = rhs.instance_count;
+    max_instance_count = rhs.max_instance_count;
     vertex_buffer_size = rhs.vertex_buffer_size;
-    index_buffer = rhs.index_buffer;
-    index_buffer_count = rhs.index_buffer_count;
-    index_buffer_size = rhs.index_buffer_size;
-    max_vertex_size = rhs.max_vertex_size;
-    max_index_size = rhs.max_index_size;
-    vertices = std::move(rhs.vertices);
+    instances = std::move(rhs.instances);
     scissor = std::move(rhs.scissor);
 
     rhs.vertex_buffer = nullptr;
-    rhs.index_buffer = nullptr;
-    rhs.vertex_buffer_count = 0;
+    rhs.instance_count = 0;
     rhs.vertex_buffer_size = 0;
-    rhs.index_buffer_count = 0;
-    rhs.index_buffer_size = 0;
   }
 
-  template <typename... Args>
-  void emplace(Args&&... args)
+  bool has_space(const uint32_t count) const { return instance_count + count <= max_instance_count; }
+
+  // Makes room for count more instances
+  void reserve(const uint32_t count)
+  {
+    assert(has_space(count));
+
+    const std::size_t required_size = instance_count + count;
+
+    if (required_size <= instances.size())
+    {
+      return;
+    }
+
+    instances.resize(std::min<std::size_t>(max_instance_count, std::max(required_size, instances.size() * 2)));
+  }
+
+  void emplace(const T& instance)
   {
-    assert(vertex_buffer_count < max_vertex_size);
-    vertices[vertex_buffer_count++] = T{std::forward<Args>(args)...};
+    assert(instance_count < instances.size());
+    instances[instance_count++] = instance;
   }
 
   void update(WGPUQueue queue)
   {
-    vertex_buffer_size = vertex_buffer_count * sizeof(T);
-    index_buffer_size = index_buffer_count * sizeof(uint32_t);
-    wgpuQueueWriteBuffer(queue, vertex_buffer, 0, vertices.data(), vertex_buffer_size);
+    vertex_buffer_size = instance_count * sizeof(T);
+    wgpuQueueWriteBuffer(queue, vertex_buffer, 0, instances.data(), vertex_buffer_size);
   }
 
   void reset()
   {
-    vertex_buffer_count = 0;
-    index_buffer_count = 0;
+    instance_count = 0;
     vertex_buffer_size = 0;
-    index_buffer_size = 0;
     scissor = {0, 0, -1, -1};
   }
 
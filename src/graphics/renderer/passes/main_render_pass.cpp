@@ -2,6 +2,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cstddef>
+
 #include "core/game_context.hpp"
 #include "graphics/camera.hpp"
 #include "graphics/display.hpp"
@@ -147,34 +149,40 @@ void MainRenderPass::load(const Shader& shader, const WGPUTextureView depth_text
   pipeline.layout = wgpuDeviceCreatePipelineLayout(m_context.device, &pipeline_layout_descriptor);
 
   // Vertex fetch
-  std::array<WGPUVertexAttribute, 4> vertex_attributes = {
+  std::array<WGPUVertexAttribute, 5> vertex_attributes = {
       WGPUVertexAttribute{
           .shaderLocation = 0,
           .format = WGPUVertexFormat_Float32x3,
-          .offset = 0,
+          .offset = offsetof(QuadData, position),
       },
       WGPUVertexAttribute{
           .shaderLocation = 1,
           .format = WGPUVertexFormat_Float32x2,
-          .offset = 3 * sizeof(float),
+          .offset = offsetof(QuadData, size),
       },
       WGPUVertexAttribute{
           .shaderLocation = 2,
-          .format = WGPUVertexFormat_Float32,
-          .offset = 5 * sizeof(float),
+          .format = WGPUVertexFormat_Unorm16x4,
+          .offset = offsetof(QuadData, texture_coordinates),
       },
       WGPUVertexAttribute{
           .shaderLocation = 3,
           .format = WGPUVertexFormat_Unorm8x4,
-          .offset = 6 * sizeof(float),
+          .offset = offsetof(QuadData, color),
+      },
+      WGPUVertexAttribute{
+          .shaderLocation = 4,
+          .format = WGPUVertexFormat_Uint8x4,
+          .offset = offsetof(QuadData, texture_id),
       },
   };
 
+  // One quad per instance, the vertex shader expands it to its six vertices
   WGPUVertexBufferLayout batch_datum_layout = {
       .attributeCount = vertex_attributes.size(),
       .attributes = vertex_attributes.data(),
-      .arrayStride = sizeof(VertexData),
-      .stepMode = WGPUVertexStepMode_Vertex,
+      .arrayStride = sizeof(QuadData),
+      .stepMode = WGPUVertexStepMode_Instance,
   };
 
   // Blend state
@@ -309,35 +317,33 @@ void MainRenderPass::render(WGPUTextureView target_view, WGPUCommandEncoder enco
     wgpuRenderPassEncoderSetBindGroup(render_pass, 0, pipeline.bind_groups[BIND_GROUP_UNIFORMS], 0, nullptr);
     wgpuRenderPassEncoderSetBindGroup(render_pass, 1, pipeline.bind_groups[BIND_GROUP_TEXTURES], 0, nullptr);
 
-    for (auto& batch_datum : batch.batch_data)
+    for (auto* batch_datum : batch.batch_data)
     {
-      if (batch_datum.index_buffer_count == 0)
+      if (batch_datum->instance_count == 0)
       {
         continue;
       }
 
       // Write vertex data to buffer
-      batch_datum.update(m_context.queue);
+      batch_datum->update(m_context.queue);
       wgpuRenderPassEncoderSetVertexBuffer(
-          render_pass, 0, batch_datum.vertex_buffer, 0, batch_datum.vertex_buffer_size);
-      wgpuRenderPassEncoderSetIndexBuffer(
-          render_pass, batch_datum.index_buffer, WGPUIndexFormat_Uint32, 0, batch_datum.index_buffer_size);
+          render_pass, 0, batch_datum->vertex_buffer, 0, batch_datum->vertex_buffer_size);
 
       // Set scissor if exists
-      if (batch_datum.has_scissor())
+      if (batch_datum->has_scissor())
       {
-        const auto& scissor = batch_datum.scissor;
+        const auto& scissor = batch_datum->scissor;
         wgpuRenderPassEncoderSetScissorRect(render_pass, scissor.x, scissor.y, scissor.z, scissor.w);
       }
 
       // Draw
-      wgpuRenderPassEncoderDrawIndexed(render_pass, batch_datum.index_buffer_count, 1, 0, 0, 0);
-
-      // Reset buffer for next frame
-      batch_datum.reset();
+      wgpuRenderPassEncoderDraw(render_pass, 6, batch_datum->instance_count, 0, 0);
     }
   }
 
+  // Reset buffers for next frame
+  batch.reset();
+
   wgpuRenderPassEncoderEnd(render_pass);
   wgpuRenderPassEncoderRelease(render_pass);
 }
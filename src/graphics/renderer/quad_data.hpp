@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "graphics/render_face.hpp"
+
+namespace dl
+{
+// Instance data of a quad, the vertex shader expands it to the corners of its face. It takes 36
+// bytes per quad instead of the 112 bytes of four vertices with float texture coordinates.
+struct QuadData
+{
+  glm::vec3 position;
+  glm::vec2 size;
+  // Top left and bottom right texture coordinates normalized to 16 bits
+  std::array<uint16_t, 4> texture_coordinates;
+  uint32_t color;
+  // Texture slot of the batch, no_texture_id for quads that only have a color
+  uint8_t texture_id;
+  uint8_t face;
+  uint16_t padding = 0;
+};
+
+static_assert(sizeof(QuadData) == 36, "QuadData must match the vertex layout of the render passes");
+
+constexpr uint8_t no_texture_id = 255;
+
+inline uint16_t encode_texture_coordinate(const float value)
+{
+  return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+inline float decode_texture_coordinate(const uint16_t value) { return value / 65535.0f; }
+
+// Negative texture indices are used for quads without texture
+inline uint8_t encode_texture_id(const float texture_index)
+{
+  return texture_index < 0.0f ? no_texture_id : static_cast<uint8_t>(texture_index);
+}
+
+// Texture coordinates are ordered top left, top right, bottom right and bottom left
+inline QuadData encode_quad(const glm::vec3& position,
+                            const glm::vec2& size,
+                            const std::array<glm::vec2, 4>& texture_coordinates,
+                            const float texture_index,
+                            const uint32_t color,
+                            const RenderFace face = DL_RENDER_FACE_TOP)
+{
+  return QuadData{
+      .position = position,
+      .size = size,
+      .texture_coordinates = {encode_texture_coordinate(texture_coordinates[0].x),
+                              encode_texture_coordinate(texture_coordinates[0].y),
+                              encode_texture_coordinate(texture_coordinates[2].x),
+                              encode_texture_coordinate(texture_coordinates[2].y)},
+      .color = color,
+      .texture_id = encode_texture_id(texture_index),
+      .face = static_cast<uint8_t>(face),
+  };
+}
+}  // namespace dl
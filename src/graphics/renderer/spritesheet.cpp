@@ -25,7 +25,18 @@ Spritesheet::Spritesheet(const WGPUDevice device, const unsigned char* data, con
 void Spritesheet::load(const WGPUDevice device)
 {
   texture->load(device);
+  m_load_frames();
+  has_loaded = true;
+}
+
+void Spritesheet::load_metadata(const Vector2i& texture_size)
+{
+  texture->size = texture_size;
+  m_load_frames();
+}
 
+void Spritesheet::m_load_frames()
+{
   // Load metadata
   if (m_data_filepath != "")
   {
@@ -35,8 +46,6 @@ void Spritesheet::load(const WGPUDevice device)
   {
     m_generate_uv_coordinates();
   }
-
-  has_loaded = true;
 }
 
 // Get top-left, top-right, bottom-right and bottom-left uv coordinates
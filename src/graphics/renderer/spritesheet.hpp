@@ -28,6 +28,8 @@ class Spritesheet
 
   // Loads after setting filepath
   void load(WGPUDevice device);
+  // Loads the frames and uv coordinates without creating the texture, for code that runs without a GPU
+  void load_metadata(const Vector2i& texture_size);
 
   [[nodiscard]] inline const Vector2i& get_size() const { return texture->size; }
   [[nodiscard]] inline const Vector2i& get_frame_size() const { return m_frame_size; }
@@ -50,6 +52,9 @@ class Spritesheet
   // Map where the key is the frame id and the value is an array of uv coordinates for a quad
   std::unordered_map<uint32_t, const std::array<glm::vec2, 4>> m_uv_coordinates{};
 
+  // Load frames from the metadata file or generate uniform ones if there is no metadata
+  void m_load_frames();
+
   // Load texture metadata from a json file
   void m_load_metadata(const std::string& filepath);
 
@@ -15,8 +15,8 @@ class Texture
   Vector2i size{};
   bool has_loaded = false;
 
-  WGPUTexture texture;
-  WGPUTextureView view;
+  WGPUTexture texture = nullptr;
+  WGPUTextureView view = nullptr;
 
   Texture(WGPUDevice device, const unsigned char* data, const Vector2i& size, int channels = 4);
   Texture(const std::string& filepath);
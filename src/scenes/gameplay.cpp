@@ -53,6 +53,7 @@ void Gameplay::load()
   auto& debug_tools = DebugTools::get_instance();
   debug_tools.init_general_info(m_game_context);
   debug_tools.init_camera_inspector(m_camera);
+  debug_tools.init_pathfinding_info(m_walk_system);
   // debug_tools.init_world_generation(m_world.chunk_manager);
   /* debug_tools.init_chunk_debugger(*this); */
   /* debug_tools.init_render_editor(m_render_system); */
@@ -135,6 +136,7 @@ void Gameplay::update()
 
   m_camera.update_target(m_registry);
   m_camera.update(m_game_context.clock->delta);
+  m_world.chunk_manager.process_requests();
   m_ui_manager.update();
 }
 
@@ -243,6 +245,7 @@ void Gameplay::render()
 
 void Gameplay::save_game()
 {
+  m_world.chunk_manager.save_dirty_chunks();
   serialization::save_game(m_world, m_game_context.world_metadata, m_registry);
 }
 
@@ -255,6 +258,7 @@ void Gameplay::load_game()
   m_camera.set_map_position(m_game_context.world_metadata.initial_position);
   m_camera.update_dirty();
   m_world.chunk_manager.load_initial_chunks(m_camera.get_position_in_tiles());
+  m_render_system.build_chunk_meshes();
 
   if (!m_world.has_initialized)
   {
@@ -277,6 +281,7 @@ void Gameplay::load_default_game()
   m_game_context.world_metadata.world_size = Vector3i{256, 256, 10};
 
   m_world.chunk_manager.load_initial_chunks(m_camera.center_in_tiles);
+  m_render_system.build_chunk_meshes();
 
   // m_world.generate_societies();
   // auto society_blueprint = m_world.get_society("otomi"_hs);
@@ -8,6 +8,7 @@
 #include <limits>
 
 #include "config.hpp"
+#include "constants.hpp"
 #include "core/game_context.hpp"
 #include "core/json.hpp"
 #include "core/maths/random.hpp"
@@ -19,6 +20,7 @@
 #include "graphics/color.hpp"
 #include "graphics/renderer/texture.hpp"
 #include "ui/compositions/world_creation_panel.hpp"
+#include "world/chunk_pregenerator.hpp"
 #include "world/generators/island_generator.hpp"
 #include "world/metadata.hpp"
 
@@ -26,6 +28,8 @@ namespace dl
 {
 WorldCreation::WorldCreation(GameContext& game_context) : Scene("world_creation", game_context) {}
 
+WorldCreation::~WorldCreation() = default;
+
 void WorldCreation::load()
 {
   world_size.x = config::world_creation::world_width;
@@ -52,7 +56,11 @@ void WorldCreation::update()
     return;
   }
 
-  if (m_input_manager.is_context("world_creation"_hs))
+  if (m_scene_state == SceneState::Pregenerating)
+  {
+    m_update_pregeneration();
+  }
+  else if (m_input_manager.is_context("world_creation"_hs))
   {
     m_update_input();
   }
@@ -130,6 +138,11 @@ bool WorldCreation::m_update_input()
 
 void WorldCreation::save()
 {
+  if (m_scene_state != SceneState::Normal)
+  {
+    return;
+  }
+
   bool is_valid = m_panel->validate() && m_selected_cell != Vector2i{-1, -1};
 
   if (!is_valid)
@@ -161,6 +174,38 @@ void WorldCreation::save()
   spdlog::debug("Seed: {}", metadata.seed);
   spdlog::debug("Id: {}", metadata.id);
 
+  m_pregenerate_chunks(metadata);
+}
+
+void WorldCreation::m_pregenerate_chunks(const WorldMetadata& metadata)
+{
+  if (config::world_creation::pregeneration_radius < 0)
+  {
+    m_scene_state = SceneState::Pop;
+    return;
+  }
+
+  // Same position the gameplay camera starts at
+  const Vector3i initial_position{
+      metadata.initial_position.x * world::map_to_tiles, metadata.initial_position.y * world::map_to_tiles, 0};
+
+  m_chunk_pregenerator = std::make_unique<ChunkPregenerator>(metadata);
+  m_chunk_pregenerator->start(initial_position, config::world_creation::pregeneration_radius);
+  m_scene_state = SceneState::Pregenerating;
+}
+
+void WorldCreation::m_update_pregeneration()
+{
+  m_panel->set_progress(m_chunk_pregenerator->get_generated_count(), m_chunk_pregenerator->get_total_count());
+
+  if (!m_chunk_pregenerator->is_done())
+  {
+    return;
+  }
+
+  spdlog::debug("Pregenerated {} chunks", m_chunk_pregenerator->get_total_count());
+
+  m_chunk_pregenerator = nullptr;
   m_scene_state = SceneState::Pop;
 }
 
@@ -18,6 +18,7 @@ class WorldCreationPanel;
 
 namespace dl
 {
+class ChunkPregenerator;
 struct Quad;
 struct GameContext;
 class Texture;
@@ -29,6 +30,7 @@ class WorldCreation : public Scene
   Vector3i world_size{256, 256, 30};
   Vector2i panel_margin{15, 15};
   WorldCreation(GameContext& game_context);
+  ~WorldCreation();
 
   void load() override;
   void update() override;
@@ -42,6 +44,7 @@ class WorldCreation : public Scene
   enum class SceneState
   {
     Normal,
+    Pregenerating,
     Pop,
   };
   SceneState m_scene_state = SceneState::Normal;
@@ -54,6 +57,7 @@ class WorldCreation : public Scene
   std::vector<BiomeType> m_biome_map{};
   InputManager& m_input_manager = InputManager::get_instance();
   ui::WorldCreationPanel* m_panel = nullptr;
+  std::unique_ptr<ChunkPregenerator> m_chunk_pregenerator = nullptr;
 
   Vector2i m_selected_cell{-1, -1};
   Vector2i m_location_selector_position{0, 0};
@@ -66,6 +70,8 @@ class WorldCreation : public Scene
 
   void m_generate_map();
   void m_generate_world();
+  void m_pregenerate_chunks(const WorldMetadata& metadata);
+  void m_update_pregeneration();
   void m_create_map_representation();
   void m_create_biome_representation();
   bool m_update_input();
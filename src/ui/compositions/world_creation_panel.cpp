@@ -1,5 +1,6 @@
 #include "./world_creation_panel.hpp"
 
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
 #include <i18n_keyval/i18n.hpp>
@@ -16,7 +17,7 @@ WorldCreationPanel::WorldCreationPanel(UIContext& context, Params params) : UICo
 {
   using namespace i18n::literals;
 
-  size = Vector2i{250, 100};
+  size = Vector2i{250, 124};
   position = Vector3i{15, 15, 0};
   placement = Placement::Absolute;
   x_alignment = XAlignement::Right;
@@ -38,6 +39,9 @@ WorldCreationPanel::WorldCreationPanel(UIContext& context, Params params) : UICo
   });
 
   m_save_button->position = Vector3i{0, 64, 0};
+
+  m_progress_label = emplace<Label>("");
+  m_progress_label->position = Vector3i{0, 104, 0};
 }
 
 std::string& WorldCreationPanel::get_name()
@@ -57,4 +61,11 @@ bool WorldCreationPanel::validate()
   return name_length > min_world_name_length && name_length < max_world_name_length;
 }
 
+void WorldCreationPanel::set_progress(const int generated_count, const int total_count)
+{
+  using namespace i18n::literals;
+
+  m_progress_label->set_text(fmt::format("{} {}/{}", "generating_world"_t, generated_count, total_count));
+}
+
 }  // namespace dl::ui
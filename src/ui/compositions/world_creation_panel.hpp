@@ -25,10 +25,14 @@ class WorldCreationPanel : public UIComponent
   std::string& get_name();
   bool validate();
 
+  // Shows how many chunks of the starting region were generated
+  void set_progress(const int generated_count, const int total_count);
+
  private:
   Label* m_label = nullptr;
   TextInput* m_text_input = nullptr;
   SpriteButton* m_save_button = nullptr;
+  Label* m_progress_label = nullptr;
 };
 
 }  // namespace dl::ui
@@ -75,30 +75,61 @@ int distance(const dl::Vector3i& a, const dl::Vector3i& b)
   // return result;
 }
 
-bool node_compare(const dl::AStar::Node& a, const dl::AStar::Node& b)
+uint64_t position_key(const dl::Vector3i& position)
 {
-  return a.f > b.f || (a.f == b.f && a.h > b.h);
+  // Positions are packed as 24 bits for x and y and 16 bits for z
+  const uint64_t x = static_cast<uint32_t>(position.x) & 0xFFFFFF;
+  const uint64_t y = static_cast<uint32_t>(position.y) & 0xFFFFFF;
+  const uint64_t z = static_cast<uint32_t>(position.z) & 0xFFFF;
+
+  return (x << 40) | (y << 16) | z;
 }
 }  // namespace
 
 namespace dl
 {
-AStar::AStar(World& world, const Vector3i& origin, const Vector3i& destination)
-    : m_world(world), origin(origin), destination(destination)
+AStar::AStar(const World& world)
+    : AStar([&world](const int x, const int y, const int z) { return world.is_walkable(x, y, z); })
+{
+}
+
+AStar::AStar(const World& world, const Vector3i& origin, const Vector3i& destination) : AStar(world)
+{
+  reset(origin, destination);
+}
+
+AStar::AStar(WalkableFunction is_walkable) : m_is_walkable(std::move(is_walkable))
+{
+  m_nodes.reserve(config::pathfinding::max_steps * 8);
+  m_open_set.reserve(config::pathfinding::max_steps * 8);
+  m_node_index.reserve(config::pathfinding::max_steps * 8);
+}
+
+void AStar::reset(const Vector3i& origin, const Vector3i& destination, const std::size_t max_steps)
 {
+  this->origin = origin;
+  this->destination = destination;
+  this->max_steps = max_steps > 0 ? max_steps : config::pathfinding::max_steps;
+  state = State::NONE;
+  steps = 0;
+  path.clear();
+  m_nodes.clear();
+  m_open_set.clear();
+  m_node_index.clear();
+
   if (origin == destination)
   {
     state = State::SUCCEEDED;
     return;
   }
 
-  if (!m_world.is_walkable(destination.x, destination.y, destination.z))
+  if (!m_is_walkable(destination.x, destination.y, destination.z))
   {
     state = State::FAILED;
     return;
   }
 
-  m_open_set.push_back(Node{origin, nullptr, 0, 0, 0});
+  m_push_open(m_add_node(origin, null_index, 0, 0));
   state = State::INITIALIZED;
 }
 
@@ -132,55 +163,56 @@ void AStar::step()
 
   ++steps;
 
-  if (steps > config::pathfinding::max_steps)
+  if (steps > max_steps)
   {
     spdlog::warn("Maximum steps for A* reached, aborting search");
     state = State::FAILED;
     return;
   }
 
-  auto current_node = m_open_set.front();
+  const uint32_t current_index = m_open_set.front();
 
   // Found the path
-  if (current_node.position == destination)
+  if (m_nodes[current_index].position == destination)
   {
     state = State::SUCCEEDED;
-    path.push_back(current_node.position);
 
-    while (current_node.parent != nullptr)
+    for (uint32_t index = current_index; index != null_index; index = m_nodes[index].parent)
     {
-      path.push_back(current_node.parent->position);
-      current_node = *current_node.parent;
+      path.push_back(m_nodes[index].position);
     }
 
     return;
   }
 
-  std::pop_heap(m_open_set.begin(), m_open_set.end(), node_compare);
-  m_open_set.pop_back();
+  m_pop_open();
+  m_nodes[current_index].closed = true;
 
-  m_closed_set.push_back(std::make_shared<Node>(current_node));
+  // Copy the values we need, m_nodes may be reallocated when adding neighbors
+  const Vector3i current_position = m_nodes[current_index].position;
+  const int current_g = m_nodes[current_index].g;
+  const int current_h = m_nodes[current_index].h;
 
   // Iterate through the 8 2D neighbors of the current node clockwise starting from the top left
-  NeighborIterator<Vector3i> it{current_node.position};
+  NeighborIterator<Vector3i> it{current_position};
 
   for (; it.neighbor != 8; ++it)
   {
     auto neighbor = *it;
     const int h = distance(neighbor, destination);
-    const bool walkable = m_world.is_walkable(neighbor.x, neighbor.y, neighbor.z);
+    const bool walkable = m_is_walkable(neighbor.x, neighbor.y, neighbor.z);
 
     // If neighbor is not walkable and it's further away from the destination than the current node, skip it
-    if (!walkable && h > current_node.h)
+    if (!walkable && h > current_h)
     {
       continue;
     }
     // If neighbor is not walkable but it's closer to the destination than the current node, check if we can climb
     // up or down. If we can, set the neighbor to the new position, otherwise skip to the next neighbor
-    else if (!walkable && h < current_node.h)
+    else if (!walkable && h < current_h)
     {
-      const bool can_climb_up = m_world.is_walkable(neighbor.x, neighbor.y, neighbor.z + 1);
-      const bool can_climb_down = m_world.is_walkable(neighbor.x, neighbor.y, neighbor.z - 1);
+      const bool can_climb_up = m_is_walkable(neighbor.x, neighbor.y, neighbor.z + 1);
+      const bool can_climb_down = m_is_walkable(neighbor.x, neighbor.y, neighbor.z - 1);
 
       if (can_climb_up)
       {
@@ -200,38 +232,35 @@ void AStar::step()
       continue;
     }
 
-    // Skip if node is in the closed set
-    const auto closed_it = std::find_if(
-        m_closed_set.begin(), m_closed_set.end(), [&neighbor](const auto& node) { return node->position == neighbor; });
+    const int g = current_g + get_cost(current_position, neighbor, it.is_diagonal);
+    const auto found = m_node_index.find(position_key(neighbor));
 
-    if (closed_it != m_closed_set.end())
+    if (found == m_node_index.end())
     {
+      m_push_open(m_add_node(neighbor, current_index, g, h));
       continue;
     }
 
-    const int g = current_node.g + m_get_cost(current_node.position, neighbor, it.is_diagonal);
-    const int f = g + h;
+    auto& node = m_nodes[found->second];
 
-    auto open_it = std::find_if(
-        m_open_set.begin(), m_open_set.end(), [&neighbor](const auto& node) { return node.position == neighbor; });
-
-    if (open_it == m_open_set.end())
+    // Skip if node is in the closed set
+    if (node.closed)
     {
-      auto& closed_node = m_closed_set[m_closed_set.size() - 1];
-
-      m_open_set.push_back(Node{neighbor, closed_node.get(), f, g, h});
-      std::push_heap(m_open_set.begin(), m_open_set.end(), node_compare);
+      continue;
     }
-    else if (g < open_it->g)
+
+    // Node is in the open set, update it if we found a cheaper path
+    if (g < node.g)
     {
-      open_it->g = g;
-      open_it->f = f;
-      open_it->parent = m_closed_set.back().get();
+      node.g = g;
+      node.f = g + node.h;
+      node.parent = current_index;
+      m_sift_up(node.heap_index);
     }
   }
 }
 
-int AStar::m_get_cost(const Vector3i& current, const Vector3i& neighbor, const bool is_diagonal) const
+int AStar::get_cost(const Vector3i& current, const Vector3i& neighbor, const bool is_diagonal)
 {
   // TODO: Get base cost from tile data
   int cost = 100;
@@ -258,6 +287,97 @@ int AStar::m_get_cost(const Vector3i& current, const Vector3i& neighbor, const b
   return cost;
 }
 
+uint32_t AStar::m_add_node(const Vector3i& position, const uint32_t parent, const int g, const int h)
+{
+  const auto node_index = static_cast<uint32_t>(m_nodes.size());
+  m_nodes.push_back(Node{position, parent, null_index, g + h, g, h, false});
+  m_node_index.emplace(position_key(position), node_index);
+  return node_index;
+}
+
+void AStar::m_push_open(const uint32_t node_index)
+{
+  const auto heap_position = static_cast<uint32_t>(m_open_set.size());
+  m_open_set.push_back(node_index);
+  m_nodes[node_index].heap_index = heap_position;
+  m_sift_up(heap_position);
+}
+
+uint32_t AStar::m_pop_open()
+{
+  const uint32_t node_index = m_open_set.front();
+  const auto last_position = static_cast<uint32_t>(m_open_set.size() - 1);
+
+  m_swap_heap(0, last_position);
+  m_open_set.pop_back();
+  m_nodes[node_index].heap_index = null_index;
+
+  if (!m_open_set.empty())
+  {
+    m_sift_down(0);
+  }
+
+  return node_index;
+}
+
+void AStar::m_sift_up(uint32_t heap_position)
+{
+  while (heap_position > 0)
+  {
+    const uint32_t parent_position = (heap_position - 1) / 2;
+
+    if (!m_less(m_open_set[heap_position], m_open_set[parent_position]))
+    {
+      break;
+    }
+
+    m_swap_heap(heap_position, parent_position);
+    heap_position = parent_position;
+  }
+}
+
+void AStar::m_sift_down(uint32_t heap_position)
+{
+  const auto size = static_cast<uint32_t>(m_open_set.size());
+
+  while (true)
+  {
+    const uint32_t left = heap_position * 2 + 1;
+    const uint32_t right = left + 1;
+    uint32_t smallest = heap_position;
+
+    if (left < size && m_less(m_open_set[left], m_open_set[smallest]))
+    {
+      smallest = left;
+    }
+    if (right < size && m_less(m_open_set[right], m_open_set[smallest]))
+    {
+      smallest = right;
+    }
+    if (smallest == heap_position)
+    {
+      break;
+    }
+
+    m_swap_heap(heap_position, smallest);
+    heap_position = smallest;
+  }
+}
+
+void AStar::m_swap_heap(const uint32_t a, const uint32_t b)
+{
+  std::swap(m_open_set[a], m_open_set[b]);
+  m_nodes[m_open_set[a]].heap_index = a;
+  m_nodes[m_open_set[b]].heap_index = b;
+}
+
+bool AStar::m_less(const uint32_t a, const uint32_t b) const
+{
+  const auto& node_a = m_nodes[a];
+  const auto& node_b = m_nodes[b];
+  return node_a.f < node_b.f || (node_a.f == node_b.f && node_a.h < node_b.h);
+}
+
 #ifdef DL_BUILD_DEBUG_TOOLS
 // Draws rectangles for the open set, closed set and path
 void AStar::debug(entt::registry& registry, const bool only_path, const bool clear_previous)
@@ -274,27 +394,23 @@ void AStar::debug(entt::registry& registry, const bool only_path, const bool cle
 
   if (!only_path)
   {
-    for (const auto& step : m_open_set)
-    {
-      auto quad = registry.create();
-      auto& q = registry.emplace<Quad>(quad, 16, 16, 0x1144cc88);
-      q.z_index = 4;
-      registry.emplace<Position>(quad,
-                                 static_cast<double>(step.position.x),
-                                 static_cast<double>(step.position.y),
-                                 static_cast<double>(step.position.z));
-      registry.emplace<entt::tag<"a_star_rectangle"_hs>>(quad);
-    }
-    for (const auto& step : m_closed_set)
+    for (const auto& node : m_nodes)
     {
+      if (node.heap_index == null_index && !node.closed)
+      {
+        continue;
+      }
+
+      // Blue for nodes in the open set and green for nodes in the closed set
+      const uint32_t color = node.closed ? 0x11cc4488 : 0x1144cc88;
+
       auto quad = registry.create();
-      auto& q = registry.emplace<Quad>(quad, 16, 16, 0x11cc4488);
+      auto& q = registry.emplace<Quad>(quad, 16, 16, color);
       q.z_index = 4;
       registry.emplace<Position>(quad,
-                                 static_cast<double>(step->position.x),
-                                 static_cast<double>(step->position.y),
-                                 static_cast<double>(step->position.z));
-
+                                 static_cast<double>(node.position.x),
+                                 static_cast<double>(node.position.y),
+                                 static_cast<double>(node.position.z));
       registry.emplace<entt::tag<"a_star_rectangle"_hs>>(quad);
     }
   }
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <memory>
+#include <functional>
+#include <limits>
+#include <unordered_map>
 #include <vector>
 
 #include "core/maths/vector.hpp"
@@ -18,8 +20,12 @@ class NeighborIterator;
 
 class AStar
 {
+ public:
+  // Tells whether a world position can be walked on
+  using WalkableFunction = std::function<bool(const int, const int, const int)>;
+
  private:
-  World& m_world;
+  WalkableFunction m_is_walkable;
 
  public:
   enum class State
@@ -31,34 +37,62 @@ class AStar
     FAILED,
   };
 
+  static constexpr uint32_t null_index = std::numeric_limits<uint32_t>::max();
+
   struct Node
   {
     Vector3i position;
-    Node* parent = nullptr;
+    uint32_t parent = null_index;
+    // Position of the node in the open set heap, null_index if it's not in the open set
+    uint32_t heap_index = null_index;
     int f = 0;
     int g = 0;
     int h = 0;
+    bool closed = false;
   };
 
   State state = State::NONE;
   Vector3i origin;
   Vector3i destination;
   std::size_t steps = 0;
+  std::size_t max_steps = 0;
   std::vector<Vector3i> path{};
 
-  AStar(World& world, const Vector3i& origin, const Vector3i& destination);
+  AStar(const World& world);
+  AStar(const World& world, const Vector3i& origin, const Vector3i& destination);
+  // Searches using a custom walkability source, e.g. a snapshot that can be read outside the main thread
+  AStar(WalkableFunction is_walkable);
+
+  // Prepares a new search keeping the memory allocated by previous searches,
+  // a max_steps of zero uses config::pathfinding::max_steps
+  void reset(const Vector3i& origin, const Vector3i& destination, const std::size_t max_steps = 0);
+  // Changes the walkability source of the next searches, keeping the allocated memory
+  void set_walkable_function(WalkableFunction is_walkable) { m_is_walkable = std::move(is_walkable); }
 
   void step();
 
+  // Cost of moving between two adjacent positions
+  static int get_cost(const Vector3i& current, const Vector3i& neighbor, const bool is_diagonal);
+
 #ifdef DL_BUILD_DEBUG_TOOLS
   // Draws rectangles for the open set, closed set and path
   void debug(entt::registry& registry, const bool only_path = true, const bool clear_previous = true);
 #endif
 
-  std::vector<Node> m_open_set{};
-  std::vector<std::shared_ptr<Node>> m_closed_set{};
+  // Arena with all nodes visited in the current search, nodes reference each other by index
+  std::vector<Node> m_nodes{};
+  // Binary min heap of node indices ordered by f and h
+  std::vector<uint32_t> m_open_set{};
+  // Maps packed positions to their index in m_nodes
+  std::unordered_map<uint64_t, uint32_t> m_node_index{};
 
  private:
-  int m_get_cost(const Vector3i& current, const Vector3i& neighbor, const bool is_diagonal) const;
+  uint32_t m_add_node(const Vector3i& position, const uint32_t parent, const int g, const int h);
+  void m_push_open(const uint32_t node_index);
+  uint32_t m_pop_open();
+  void m_sift_up(uint32_t heap_position);
+  void m_sift_down(uint32_t heap_position);
+  void m_swap_heap(const uint32_t a, const uint32_t b);
+  bool m_less(const uint32_t a, const uint32_t b) const;
 };
 }  // namespace dl
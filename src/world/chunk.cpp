@@ -0,0 +1,66 @@
+#include "./chunk.hpp"
+
+#include "./tile_flag.hpp"
+
+namespace
+{
+bool is_cell_walkable(const dl::Cell& cell, const std::vector<uint32_t>& tile_flags)
+{
+  // The decoration takes precedence over the tile below it, same as World::get
+  const uint32_t id = cell.top_face_decoration != 0 ? cell.top_face_decoration : cell.top_face;
+  return id < tile_flags.size() && (tile_flags[id] & dl::DL_TILE_FLAG_WALKABLE);
+}
+}  // namespace
+
+namespace dl
+{
+void Chunk::compute_walkability(const std::vector<uint32_t>& tile_flags)
+{
+  const std::size_t cell_count = tiles.size.x * tiles.size.y * tiles.size.z;
+
+  walkable_cells.assign((cell_count + 63) / 64, 0);
+
+  for (std::size_t i = 0; i < cell_count; ++i)
+  {
+    if (is_cell_walkable(tiles.cell_at_index(i), tile_flags))
+    {
+      walkable_cells[i / 64] |= uint64_t{1} << (i % 64);
+    }
+  }
+}
+
+void Chunk::update_walkability(const std::vector<uint32_t>& tile_flags, const int x, const int y, const int z)
+{
+  const auto& size = tiles.size;
+
+  if (x < 0 || y < 0 || z < 0 || x >= size.x || y >= size.y || z >= size.z || walkable_cells.empty())
+  {
+    return;
+  }
+
+  const std::size_t index = x + y * size.x + z * size.x * size.y;
+  const uint64_t bit = uint64_t{1} << (index % 64);
+
+  if (is_cell_walkable(tiles.cell_at_index(index), tile_flags))
+  {
+    walkable_cells[index / 64] |= bit;
+  }
+  else
+  {
+    walkable_cells[index / 64] &= ~bit;
+  }
+}
+
+bool Chunk::is_walkable(const int x, const int y, const int z) const
+{
+  const auto& size = tiles.size;
+
+  if (x < 0 || y < 0 || z < 0 || x >= size.x || y >= size.y || z >= size.z || walkable_cells.empty())
+  {
+    return false;
+  }
+
+  const std::size_t index = x + y * size.x + z * size.x * size.y;
+  return (walkable_cells[index / 64] >> (index % 64)) & 1;
+}
+}  // namespace dl
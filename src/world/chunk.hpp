@@ -1,15 +1,31 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "./grid_3d.hpp"
 #include "core/maths/vector.hpp"
 
 namespace dl
 {
+struct ChunkMesh;
+
 struct Chunk
 {
   Vector3i position;
   bool active = false;
+  // Unique among all chunks and renewed whenever the tiles are modified, allows
+  // data derived from the tiles to be cached and invalidated
+  uint32_t revision = next_revision();
+  // Set when the tiles differ from the saved chunk
+  bool is_dirty = false;
   Grid3D tiles{};
+  // One bit per cell in the same layout as the tiles, set if the cell can be walked on
+  std::vector<uint64_t> walkable_cells{};
+  // Tile quads built by the renderer, outdated when its revision differs from the chunk revision
+  std::shared_ptr<const ChunkMesh> mesh = nullptr;
 
   Chunk() = default;
   Chunk(const Vector3i& position, const bool active)
@@ -17,5 +33,24 @@ struct Chunk
     this->position = position;
     this->active = active;
   }
+
+  void mark_modified()
+  {
+    revision = next_revision();
+    is_dirty = true;
+  }
+
+  // Derives the walkable cells from the tiles, tile_flags is a TileFlag bitmask table indexed by tile id
+  void compute_walkability(const std::vector<uint32_t>& tile_flags);
+  void update_walkability(const std::vector<uint32_t>& tile_flags, const int x, const int y, const int z);
+
+  // Queries a position relative to the chunk origin
+  bool is_walkable(const int x, const int y, const int z) const;
+
+  static uint32_t next_revision()
+  {
+    static std::atomic<uint32_t> revision_counter = 0;
+    return ++revision_counter;
+  }
 };
 }  // namespace dl
@@ -2,10 +2,13 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <cmath>
 #include <thread>
 
 #include "./generators/chunk_generator.hpp"
+#include "./generators/tile_procedure_manager.hpp"
+#include "config.hpp"
 #include "constants.hpp"
 #include "core/game_context.hpp"
 #include "core/maths/neighbor_iterator.hpp"
@@ -16,6 +19,8 @@ namespace dl
 {
 Chunk ChunkManager::null = Chunk{};
 std::mutex ChunkManager::m_chunks_to_add_mutex = std::mutex{};
+std::atomic<uint32_t> ChunkManager::m_generation_counter = 0;
+thread_local ChunkManager::LastChunkCache ChunkManager::m_last_chunk{};
 
 ChunkManager::ChunkManager(GameContext& game_context)
     : m_game_context(game_context), m_world_metadata(game_context.world_metadata)
@@ -26,7 +31,13 @@ ChunkManager::ChunkManager(GameContext& game_context)
   // #endif
 
   m_seed = m_game_context.world_metadata.seed;
+  m_invalidate_cache();
+
+  // Not thread safe, initialize it before the workers generate chunks
+  TileProcedureManager::init();
+
   m_thread_pool.initialize();
+  m_max_chunks_in_flight = std::max(1u, std::thread::hardware_concurrency());
 }
 
 ChunkManager::~ChunkManager()
@@ -35,10 +46,20 @@ ChunkManager::~ChunkManager()
   {
   }
   m_thread_pool.finalize();
+
+  save_dirty_chunks();
+  m_save_queue.flush();
 }
 
 void ChunkManager::load_or_generate(const Vector3i& position)
 {
+  // Chunks waiting to be saved are more recent than the ones on disk
+  if (auto chunk = m_save_queue.get(position); chunk != nullptr)
+  {
+    m_add_chunk(std::move(chunk));
+    return;
+  }
+
 #ifdef DL_BUILD_DEBUG_TOOLS
   if (mode == Mode::NoLoadingOrSaving)
   {
@@ -81,8 +102,17 @@ void ChunkManager::regenerate_chunks()
 {
   spdlog::debug("Regenerating chunks");
   chunks.clear();
+  m_chunk_index.clear();
   m_chunks_loading.clear();
-  m_chunks_to_add.clear();
+  m_chunk_requests.clear();
+
+  {
+    // Chunks still in flight are discarded when they arrive as they are no longer being loaded
+    const std::unique_lock<std::mutex> lock(m_chunks_to_add_mutex);
+    m_chunks_to_add.clear();
+  }
+
+  m_invalidate_cache();
   update({0, 0, 0});
 }
 #endif
@@ -91,6 +121,8 @@ void ChunkManager::load_initial_chunks(const Vector3i& target)
 {
   const int padding = 1;
 
+  m_target = target;
+
   {
     // Load visible chunks
     const auto top_left_position
@@ -119,6 +151,8 @@ void ChunkManager::update(const Vector3i& target)
 {
   const int padding = 1;
 
+  m_target = target;
+
   {
     // Load visible chunks
     const auto top_left_position
@@ -134,7 +168,16 @@ void ChunkManager::update(const Vector3i& target)
       {
         const auto& candidate = world_to_chunk(i, j, target.z);
 
-        if (!is_loaded(candidate))
+        if (is_loaded(candidate))
+        {
+          continue;
+        }
+
+        if (config::world::stream_chunks)
+        {
+          load_async(candidate);
+        }
+        else
         {
           load_or_generate(candidate);
         }
@@ -143,122 +186,137 @@ void ChunkManager::update(const Vector3i& target)
   }
 
   {
-    const auto target_chunk_position = world_to_chunk(target);
+    // Unload chunks within a certain radius
+    const auto unloaded_count = std::erase_if(chunks,
+                                              [this](auto& chunk)
+                                              {
+                                                const bool should_unload = m_should_unload(chunk->position);
 
-    // Activate / Deactivate chunks within a certain radius
-    // activate_if([this, &target_chunk_position](const auto& chunk) {
-    //   return is_within_tile_distance(chunk->position, target_chunk_position, Vector2i{frustum.x * 2, frustum.y * 2});
-    // });
+                                                if (should_unload)
+                                                {
+                                                  m_chunk_index.erase(chunk_key(chunk->position));
 
-    // Unload chunks within a certain radius
-    std::erase_if(chunks,
-                  [this, &target_chunk_position](const auto& chunk)
+                                                  if (chunk->is_dirty && m_is_saving_enabled())
+                                                  {
+                                                    m_save_queue.push(std::move(chunk));
+                                                  }
+                                                }
+
+                                                return should_unload;
+                                              });
+
+    if (unloaded_count > 0)
+    {
+      m_invalidate_cache();
+    }
+
+    // Cancel requests that weren't dispatched yet and went out of range
+    std::erase_if(m_chunk_requests,
+                  [this](const auto& position)
                   {
-                    return !is_within_tile_distance(
-                        chunk->position,
-                        target_chunk_position,
-                        Vector2i{frustum.x + 2 * world::chunk_size.x, frustum.y + 2 * world::chunk_size.y});
+                    const bool should_unload = m_should_unload(position);
+
+                    if (should_unload)
+                    {
+                      m_chunks_loading.erase(chunk_key(position));
+                    }
+
+                    return should_unload;
                   });
   }
+}
+
+void ChunkManager::process_requests()
+{
+  if (config::world::chunk_autosave_interval > 0.0
+      && std::chrono::steady_clock::now() - m_last_autosave
+             >= std::chrono::duration<double>(config::world::chunk_autosave_interval))
+  {
+    save_dirty_chunks();
+  }
+
+  {
+    // Dispatch the closest requests while there are workers available, chunks that
+    // finished loading but weren't added yet also count as in flight
+    std::sort(m_chunk_requests.begin(),
+              m_chunk_requests.end(),
+              [this](const auto& a, const auto& b)
+              { return m_get_distance_to_target(a) > m_get_distance_to_target(b); });
+
+    while (!m_chunk_requests.empty() && m_chunks_loading.size() - m_chunk_requests.size() < m_max_chunks_in_flight)
+    {
+      const auto position = m_chunk_requests.back();
+      m_chunk_requests.pop_back();
+      m_thread_pool.queue_job([this, position] { m_load_or_generate_async(position); });
+    }
+  }
 
   {
     // Incorporate newly loaded / generated chunks
     const std::unique_lock<std::mutex> lock(m_chunks_to_add_mutex);
-    if (m_chunks_to_add.size() > 0)
+
+    if (m_chunks_to_add.empty())
+    {
+      return;
+    }
+
+    std::sort(m_chunks_to_add.begin(),
+              m_chunks_to_add.end(),
+              [this](const auto& a, const auto& b)
+              { return m_get_distance_to_target(a.first) > m_get_distance_to_target(b.first); });
+
+    for (uint32_t i = 0; i < config::world::chunks_added_per_frame && !m_chunks_to_add.empty(); ++i)
     {
-      for (auto& chunk : m_chunks_to_add)
+      auto [position, chunk] = std::move(m_chunks_to_add.back());
+      m_chunks_to_add.pop_back();
+
+      // Discard chunks that were cancelled or went out of range while loading, a chunk
+      // that failed to load is requested again in the next update
+      if (m_chunks_loading.erase(chunk_key(position)) == 0 || chunk == nullptr || m_should_unload(position))
       {
-        std::erase_if(m_chunks_loading, [&chunk](const auto& position) { return chunk->position == position; });
+        continue;
       }
-      chunks.insert(chunks.end(),
-                    std::make_move_iterator(m_chunks_to_add.begin()),
-                    std::make_move_iterator(m_chunks_to_add.end()));
-      m_chunks_to_add.clear();
+
+      m_add_chunk(std::move(chunk));
     }
   }
 }
 
 bool ChunkManager::is_loaded(const Vector3i& position) const
 {
-  const auto found = std::find_if(
-      chunks.begin(), chunks.end(), [&position](const auto& chunk) { return chunk->position == position; });
-
-  const auto found_generating
-      = std::find_if(m_chunks_loading.begin(),
-                     m_chunks_loading.end(),
-                     [&position](const auto& chunk_position) { return position == chunk_position; });
-
-  return found != chunks.end() || found_generating != m_chunks_loading.end();
+  const auto key = chunk_key(position);
+  return m_chunk_index.contains(key) || m_chunks_loading.contains(key);
 }
 
 void ChunkManager::load_async(const Vector3i& position)
 {
-  const auto found
-      = std::find_if(m_chunks_loading.begin(),
-                     m_chunks_loading.end(),
-                     [&position](const Vector3i& generating_position) { return generating_position == position; });
-
-  if (found == m_chunks_loading.end())
-  {
-    m_thread_pool.queue_job([this, position, size = world::chunk_size]
-                            { generate_async(std::ref(position), std::ref(size), std::ref(m_chunks_to_add_mutex)); });
-    m_chunks_loading.push_back(position);
-  }
-}
-
-void ChunkManager::generate_async(const Vector3i& position, const Vector3i& size, std::mutex& mutex)
-{
-  ChunkGenerator generator{m_world_metadata};
-  // GameChunkGenerator generator{};
-  generator.set_size(size);
-  generator.generate(m_seed, position);
-  // auto chunk = std::make_unique<Chunk>(position, true);
-  // chunk->tiles.set_size(size);
-  // chunk->tiles.values = std::move(generator.tiles);
-  // chunk->tiles.height_map = std::move(generator.height_map);
-  // chunk->tiles.compute_visibility();
+  const auto [it, inserted] = m_chunks_loading.insert(chunk_key(position));
+  (void)it;
 
+  if (inserted)
   {
-    const std::unique_lock<std::mutex> lock(mutex);
-    m_chunks_to_add.push_back(std::move(generator.chunk));
+    m_chunk_requests.push_back(position);
   }
 }
 
 void ChunkManager::load_sync(const Vector3i& position)
 {
-  // Timer timer{};
-  // timer.start();
-
-  auto chunk = std::make_unique<Chunk>(position, true);
-  chunk->tiles.set_size(world::chunk_size);
-  serialization::load_game_chunk(*chunk, m_game_context.world_metadata.id);
+  auto chunk = m_load_chunk(position);
 
-  // spdlog::debug("Chunk size: {} {} {}", chunk->tiles.size.x, chunk->tiles.size.y, chunk->tiles.size.z);
-  // timer.stop();
-  // timer.print(fmt::format("Chunk ({}, {}, {})", position.x, position.y, position.z));
-
-  if (chunk->tiles.height_map.size() != static_cast<uint32_t>(world::chunk_size.x * world::chunk_size.y))
+  if (chunk == nullptr)
   {
-    spdlog::critical("Could not load chunk: invalid height map size");
     return;
   }
 
-  chunks.push_back(std::move(chunk));
+  m_prepare_chunk(*chunk);
+  m_add_chunk(std::move(chunk));
 }
 
 void ChunkManager::generate_sync(const Vector3i& position, const Vector3i& size)
 {
-  ChunkGenerator generator{m_world_metadata};
-  // GameChunkGenerator generator{};
-
-#ifdef DL_BUILD_DEBUG_TOOLS
-  // generator.island_params = island_params;
-#endif
-
-  generator.set_size(size);
-  generator.generate(m_seed, position);
-  serialization::save_game_chunk(*generator.chunk, m_game_context.world_metadata.id);
-  chunks.push_back(std::move(generator.chunk));
+  auto chunk = m_generate_chunk(position, size);
+  m_prepare_chunk(*chunk);
+  m_add_chunk(std::move(chunk));
 }
 
 void ChunkManager::set_frustum(const Vector2i& frustum)
@@ -266,19 +324,52 @@ void ChunkManager::set_frustum(const Vector2i& frustum)
   this->frustum = frustum;
 }
 
+void ChunkManager::save_dirty_chunks()
+{
+  m_last_autosave = std::chrono::steady_clock::now();
+
+  if (!m_is_saving_enabled())
+  {
+    return;
+  }
+
+  for (auto& chunk : chunks)
+  {
+    if (!chunk->is_dirty)
+    {
+      continue;
+    }
+
+    // Drops the palette cells that edits left unused
+    if (chunk->tiles.is_compact())
+    {
+      chunk->tiles.compact();
+    }
+
+    // The copy is cheap for compact chunks and lets the chunk keep being modified while it's saved
+    m_save_queue.push(std::make_unique<Chunk>(*chunk));
+    chunk->is_dirty = false;
+  }
+}
+
 Chunk& ChunkManager::at(const int x, const int y, const int z) const
 {
-  const Vector3i chunk_position = world_to_chunk(x, y, z);
+  const auto key = chunk_key(world_to_chunk(x, y, z));
+  const uint32_t generation = m_generation_counter.load(std::memory_order_acquire);
+
+  if (m_last_chunk.owner == this && m_last_chunk.generation == generation && m_last_chunk.key == key)
+  {
+    return *m_last_chunk.chunk;
+  }
 
-  const auto chunk = std::find_if(chunks.begin(),
-                                  chunks.end(),
-                                  [&chunk_position](const auto& chunk) { return (chunk->position == chunk_position); });
+  const auto chunk = m_chunk_index.find(key);
 
-  /* assert(chunk != chunks.end() && "Chunk should be already generated during update"); */
+  /* assert(chunk != m_chunk_index.end() && "Chunk should be already generated during update"); */
 
-  if (chunk != chunks.end())
+  if (chunk != m_chunk_index.end())
   {
-    return *(*chunk).get();
+    m_last_chunk = LastChunkCache{this, generation, key, chunk->second};
+    return *chunk->second;
   }
 
   /* spdlog::warn("Should't be generating a chunk here"); */
@@ -293,18 +384,7 @@ Chunk& ChunkManager::at(const Vector3i& position) const
 
 Chunk& ChunkManager::in(const int x, const int y, const int z) const
 {
-  const Vector3i chunk_position = world_to_chunk(x, y, z);
-
-  const auto chunk = std::find_if(chunks.begin(),
-                                  chunks.end(),
-                                  [&chunk_position](const auto& chunk) { return (chunk->position == chunk_position); });
-
-  if (chunk != chunks.end())
-  {
-    return *(*chunk).get();
-  }
-
-  return ChunkManager::null;
+  return at(x, y, z);
 }
 
 Chunk& ChunkManager::in(const Vector3i& position) const
@@ -312,14 +392,18 @@ Chunk& ChunkManager::in(const Vector3i& position) const
   return in(position.x, position.y, position.z);
 }
 
-Vector3i ChunkManager::world_to_chunk(const int x, const int y, const int z) const
+Vector3i ChunkManager::world_to_chunk(const int x, const int y, const int z)
 {
-  return Vector3i{std::floor(x / static_cast<float>(world::chunk_size.x)) * world::chunk_size.x,
-                  std::floor(y / static_cast<float>(world::chunk_size.y)) * world::chunk_size.y,
-                  std::floor(z / static_cast<float>(world::chunk_size.z)) * world::chunk_size.z};
+  // Integer floor division so that negative coordinates map to the chunk on their left
+  const auto floor_to_chunk = [](const int value, const int chunk_size)
+  { return (value >= 0 ? value / chunk_size : (value - chunk_size + 1) / chunk_size) * chunk_size; };
+
+  return Vector3i{floor_to_chunk(x, world::chunk_size.x),
+                  floor_to_chunk(y, world::chunk_size.y),
+                  floor_to_chunk(z, world::chunk_size.z)};
 }
 
-Vector3i ChunkManager::world_to_chunk(const Vector3i& position) const
+Vector3i ChunkManager::world_to_chunk(const Vector3i& position)
 {
   return world_to_chunk(position.x, position.y, position.z);
 }
@@ -359,4 +443,144 @@ void ChunkManager::activate_if(const std::function<bool(const std::unique_ptr<Ch
   }
 }
 
+void ChunkManager::set_tile_flags(const std::vector<uint32_t>& tile_flags) { m_tile_flags = &tile_flags; }
+
+void ChunkManager::m_load_or_generate_async(const Vector3i& position)
+{
+  auto chunk = m_save_queue.get(position);
+
+  if (chunk != nullptr)
+  {
+    // Chunks waiting to be saved are more recent than the ones on disk and were already prepared
+    const std::unique_lock<std::mutex> lock(m_chunks_to_add_mutex);
+    m_chunks_to_add.emplace_back(position, std::move(chunk));
+    return;
+  }
+
+#ifdef DL_BUILD_DEBUG_TOOLS
+  const bool should_load = mode != Mode::NoLoadingOrSaving
+                           && serialization::chunk_exists(position, m_game_context.world_metadata.id);
+#else
+  const bool should_load = serialization::chunk_exists(position, m_game_context.world_metadata.id);
+#endif
+
+  if (should_load)
+  {
+    chunk = m_load_chunk(position);
+  }
+  else
+  {
+    chunk = m_generate_chunk(position, world::chunk_size);
+  }
+
+  if (chunk != nullptr)
+  {
+    m_prepare_chunk(*chunk);
+  }
+
+  const std::unique_lock<std::mutex> lock(m_chunks_to_add_mutex);
+  m_chunks_to_add.emplace_back(position, std::move(chunk));
+}
+
+std::unique_ptr<Chunk> ChunkManager::m_load_chunk(const Vector3i& position) const
+{
+  auto chunk = std::make_unique<Chunk>(position, true);
+  chunk->tiles.set_size(world::chunk_size);
+  serialization::load_game_chunk(*chunk, m_game_context.world_metadata.id);
+
+  if (chunk->tiles.height_map.size() != static_cast<uint32_t>(world::chunk_size.x * world::chunk_size.y))
+  {
+    spdlog::critical("Could not load chunk: invalid height map size");
+    return nullptr;
+  }
+
+  return chunk;
+}
+
+std::unique_ptr<Chunk> ChunkManager::m_generate_chunk(const Vector3i& position, const Vector3i& size) const
+{
+  ChunkGenerator generator{m_world_metadata};
+  generator.set_size(size);
+  generator.generate(m_seed, position);
+
+  // New chunks are saved when they are unloaded or on autosave
+  generator.chunk->is_dirty = true;
+  return std::move(generator.chunk);
+}
+
+void ChunkManager::m_prepare_chunk(Chunk& chunk) const
+{
+  if (m_tile_flags != nullptr)
+  {
+    chunk.compute_walkability(*m_tile_flags);
+  }
+
+  if (config::world::compact_chunks)
+  {
+    const auto dense_memory_usage = chunk.tiles.get_memory_usage();
+    chunk.tiles.compact();
+
+    spdlog::debug("Compacted chunk ({}, {}, {}): {} -> {} bytes",
+                  chunk.position.x,
+                  chunk.position.y,
+                  chunk.position.z,
+                  dense_memory_usage,
+                  chunk.tiles.get_memory_usage());
+  }
+}
+
+void ChunkManager::m_add_chunk(std::unique_ptr<Chunk> chunk)
+{
+  const auto key = chunk_key(chunk->position);
+
+  // Replace a chunk that was loaded twice instead of keeping a dangling entry in the index
+  if (m_chunk_index.contains(key))
+  {
+    std::erase_if(chunks, [key](const auto& loaded_chunk) { return chunk_key(loaded_chunk->position) == key; });
+    m_invalidate_cache();
+  }
+
+  m_chunk_index[key] = chunk.get();
+  chunks.push_back(std::move(chunk));
+}
+
+int ChunkManager::m_get_distance_to_target(const Vector3i& chunk_position) const
+{
+  const auto center = world_to_chunk(m_target.x + frustum.x / 2, m_target.y + frustum.y / 2, m_target.z);
+  const int dx = (chunk_position.x - center.x) / world::chunk_size.x;
+  const int dy = (chunk_position.y - center.y) / world::chunk_size.y;
+  return dx * dx + dy * dy;
+}
+
+bool ChunkManager::m_is_saving_enabled() const
+{
+#ifdef DL_BUILD_DEBUG_TOOLS
+  return mode != Mode::NoLoadingOrSaving;
+#else
+  return true;
+#endif
+}
+
+bool ChunkManager::m_should_unload(const Vector3i& chunk_position) const
+{
+  return !is_within_tile_distance(chunk_position,
+                                  world_to_chunk(m_target),
+                                  Vector2i{frustum.x + 2 * world::chunk_size.x, frustum.y + 2 * world::chunk_size.y});
+}
+
+void ChunkManager::m_invalidate_cache()
+{
+  m_generation_counter.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t ChunkManager::chunk_key(const Vector3i& chunk_position)
+{
+  // Chunk coordinates are packed as 24 bits for x and y and 16 bits for z
+  const uint64_t x = static_cast<uint32_t>(chunk_position.x / world::chunk_size.x) & 0xFFFFFF;
+  const uint64_t y = static_cast<uint32_t>(chunk_position.y / world::chunk_size.y) & 0xFFFFFF;
+  const uint64_t z = static_cast<uint32_t>(chunk_position.z / world::chunk_size.z) & 0xFFFF;
+
+  return (x << 40) | (y << 16) | z;
+}
+
 }  // namespace dl
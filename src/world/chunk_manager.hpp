@@ -1,10 +1,16 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "./chunk.hpp"
+#include "./chunk_save_queue.hpp"
 #include "core/maths/vector.hpp"
 #include "core/thread_pool.hpp"
 #include "definitions.hpp"
@@ -46,13 +52,18 @@ class ChunkManager
 
   // Update chunks based on a tile position
   void update(const Vector3i& target);
+  // Dispatches requested chunks to the workers, closest to the target first, and incorporates
+  // chunks that finished loading within the per frame budget. Should be called once per frame.
+  void process_requests();
   void load_or_generate(const Vector3i& position);
   void load_initial_chunks(const Vector3i& position);
+  // Requests a chunk to be loaded or generated in the background
   void load_async(const Vector3i& position);
   void load_sync(const Vector3i& position);
-  void generate_async(const Vector3i& position, const Vector3i& size, std::mutex& mutex);
   void generate_sync(const Vector3i& position, const Vector3i& size);
   void set_frustum(const Vector2i& frustum);
+  // Queues all the modified chunks to be saved in the background
+  void save_dirty_chunks();
 
   // Gets chunk at a precise location
   Chunk& at(const int x, const int y, const int z) const;
@@ -62,8 +73,11 @@ class ChunkManager
   Chunk& in(const int x, const int y, const int z) const;
   Chunk& in(const Vector3i& position) const;
 
-  Vector3i world_to_chunk(const int x, const int y, const int z) const;
-  Vector3i world_to_chunk(const Vector3i& position) const;
+  static Vector3i world_to_chunk(const int x, const int y, const int z);
+  static Vector3i world_to_chunk(const Vector3i& position);
+
+  // Packs a chunk position into a key for chunk lookups
+  static uint64_t chunk_key(const Vector3i& chunk_position);
 
   bool is_loaded(const Vector3i& position) const;
   bool is_within_tile_radius(const Vector3i& origin, const Vector3i& target, const int radius) const;
@@ -71,13 +85,58 @@ class ChunkManager
   bool is_within_chunk_radius(const Vector3i& origin, const Vector3i& target, const int radius) const;
   void activate_if(const std::function<bool(const std::unique_ptr<Chunk>&)>& condition);
 
+  // Table of TileFlag bitmasks indexed by tile id, used to derive the walkable cells of new chunks
+  void set_tile_flags(const std::vector<uint32_t>& tile_flags);
+
  private:
+  // Last chunk returned by a lookup in the current thread. Consecutive queries
+  // tend to fall in the same chunk (A* neighbours, flood fills, rendering a chunk
+  // column), so this avoids hashing in the common case.
+  struct LastChunkCache
+  {
+    const ChunkManager* owner = nullptr;
+    uint32_t generation = 0;
+    uint64_t key = 0;
+    Chunk* chunk = nullptr;
+  };
+
   GameContext& m_game_context;
   const WorldMetadata& m_world_metadata;
-  std::vector<Vector3i> m_chunks_loading{};
-  std::vector<std::unique_ptr<Chunk>> m_chunks_to_add{};
+  std::unordered_map<uint64_t, Chunk*> m_chunk_index{};
+  // Chunks requested, being loaded or waiting to be added
+  std::unordered_set<uint64_t> m_chunks_loading{};
+  // Requested chunks that weren't dispatched to a worker yet
+  std::vector<Vector3i> m_chunk_requests{};
+  // Chunks loaded by the workers, null if the chunk couldn't be loaded
+  std::vector<std::pair<Vector3i, std::unique_ptr<Chunk>>> m_chunks_to_add{};
   static std::mutex m_chunks_to_add_mutex;
   ThreadPool m_thread_pool{};
+  uint32_t m_max_chunks_in_flight = 1;
+  Vector3i m_target{};
+  ChunkSaveQueue m_save_queue{m_world_metadata};
+  std::chrono::steady_clock::time_point m_last_autosave = std::chrono::steady_clock::now();
+  const std::vector<uint32_t>* m_tile_flags = nullptr;
   int m_seed = 0;
+  static std::atomic<uint32_t> m_generation_counter;
+  static thread_local LastChunkCache m_last_chunk;
+
+  // Loads or generates a chunk in a worker thread
+  void m_load_or_generate_async(const Vector3i& position);
+  std::unique_ptr<Chunk> m_load_chunk(const Vector3i& position) const;
+  std::unique_ptr<Chunk> m_generate_chunk(const Vector3i& position, const Vector3i& size) const;
+
+  // Derives data from the tiles of a new chunk, safe to call from the workers
+  void m_prepare_chunk(Chunk& chunk) const;
+
+  // Takes ownership of a chunk and adds it to the index
+  void m_add_chunk(std::unique_ptr<Chunk> chunk);
+
+  // Squared distance in chunks between a chunk and the center of the frustum
+  int m_get_distance_to_target(const Vector3i& chunk_position) const;
+  bool m_should_unload(const Vector3i& chunk_position) const;
+  bool m_is_saving_enabled() const;
+
+  // Invalidates the last chunk caches of all threads
+  void m_invalidate_cache();
 };
 };  // namespace dl
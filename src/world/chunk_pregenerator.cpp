@@ -0,0 +1,64 @@
+#include "./chunk_pregenerator.hpp"
+
+#include "constants.hpp"
+#include "core/serialization.hpp"
+#include "world/chunk.hpp"
+#include "world/chunk_manager.hpp"
+#include "world/generators/chunk_generator.hpp"
+#include "world/generators/tile_procedure_manager.hpp"
+
+namespace dl
+{
+ChunkPregenerator::ChunkPregenerator(const WorldMetadata& world_metadata) : m_world_metadata(world_metadata) {}
+
+ChunkPregenerator::~ChunkPregenerator()
+{
+  // Chunks that were not generated yet are left for the chunk manager
+  m_thread_pool.finalize();
+}
+
+void ChunkPregenerator::start(const Vector3i& position, const int radius)
+{
+  // Not thread safe, initialize it before the workers use it
+  TileProcedureManager::init();
+
+  const auto center = ChunkManager::world_to_chunk(position);
+
+  m_generated_count = 0;
+  m_total_count = (radius * 2 + 1) * (radius * 2 + 1);
+  m_thread_pool.initialize();
+
+  // Closest chunks first
+  for (int distance = 0; distance <= radius; ++distance)
+  {
+    for (int j = -distance; j <= distance; ++j)
+    {
+      for (int i = -distance; i <= distance; ++i)
+      {
+        if (std::max(std::abs(i), std::abs(j)) != distance)
+        {
+          continue;
+        }
+
+        const Vector3i chunk_position{
+            center.x + i * world::chunk_size.x, center.y + j * world::chunk_size.y, center.z};
+
+        m_thread_pool.queue_job([this, chunk_position] { m_generate(chunk_position); });
+      }
+    }
+  }
+}
+
+void ChunkPregenerator::m_generate(const Vector3i& position)
+{
+  if (!serialization::chunk_exists(position, m_world_metadata.id))
+  {
+    ChunkGenerator generator{m_world_metadata};
+    generator.set_size(world::chunk_size);
+    generator.generate(m_world_metadata.seed, position);
+    serialization::save_game_chunk(*generator.chunk, m_world_metadata.id);
+  }
+
+  ++m_generated_count;
+}
+}  // namespace dl
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+
+#include "core/maths/vector.hpp"
+#include "core/thread_pool.hpp"
+#include "world/metadata.hpp"
+
+namespace dl
+{
+// Generates and saves the chunks around a position in background threads, so that
+// starting a new game only needs to load them
+class ChunkPregenerator
+{
+ public:
+  ChunkPregenerator(const WorldMetadata& world_metadata);
+  ~ChunkPregenerator();
+
+  ChunkPregenerator(const ChunkPregenerator&) = delete;
+  ChunkPregenerator& operator=(const ChunkPregenerator&) = delete;
+
+  // Queues the chunks within radius chunks of a position in tiles
+  void start(const Vector3i& position, const int radius);
+
+  bool is_done() const { return m_generated_count == m_total_count; }
+  int get_generated_count() const { return m_generated_count; }
+  int get_total_count() const { return m_total_count; }
+
+ private:
+  // Copy of the metadata since the generators keep a reference to it while running
+  const WorldMetadata m_world_metadata;
+  ThreadPool m_thread_pool{};
+  std::atomic<int> m_generated_count = 0;
+  int m_total_count = 0;
+
+  void m_generate(const Vector3i& position);
+};
+}  // namespace dl
@@ -0,0 +1,95 @@
+#include "./chunk_save_queue.hpp"
+
+#include "./chunk_manager.hpp"
+#include "core/serialization.hpp"
+#include "world/metadata.hpp"
+
+namespace dl
+{
+ChunkSaveQueue::ChunkSaveQueue(const WorldMetadata& world_metadata) : m_world_metadata(world_metadata)
+{
+  // A single thread keeps writes to the same region file in order
+  m_thread_pool.initialize(1);
+}
+
+ChunkSaveQueue::~ChunkSaveQueue()
+{
+  flush();
+  m_thread_pool.finalize();
+}
+
+void ChunkSaveQueue::push(std::unique_ptr<Chunk> chunk)
+{
+  const auto key = ChunkManager::chunk_key(chunk->position);
+  bool is_queued = false;
+
+  {
+    const std::scoped_lock lock{m_mutex};
+    auto& queued_chunk = m_chunks[key];
+    is_queued = queued_chunk != nullptr;
+    queued_chunk = std::move(chunk);
+  }
+
+  // The job that is already queued writes the latest version
+  if (!is_queued)
+  {
+    m_thread_pool.queue_job([this, key] { m_save(key); });
+  }
+}
+
+std::unique_ptr<Chunk> ChunkSaveQueue::get(const Vector3i& position) const
+{
+  const std::scoped_lock lock{m_mutex};
+  const auto it = m_chunks.find(ChunkManager::chunk_key(position));
+
+  if (it == m_chunks.end())
+  {
+    return nullptr;
+  }
+
+  return std::make_unique<Chunk>(*it->second);
+}
+
+void ChunkSaveQueue::flush()
+{
+  std::unique_lock lock{m_mutex};
+  m_condition.wait(lock, [this] { return m_chunks.empty(); });
+}
+
+std::size_t ChunkSaveQueue::size() const
+{
+  const std::scoped_lock lock{m_mutex};
+  return m_chunks.size();
+}
+
+void ChunkSaveQueue::m_save(const uint64_t key)
+{
+  while (true)
+  {
+    std::shared_ptr<const Chunk> chunk = nullptr;
+
+    {
+      const std::scoped_lock lock{m_mutex};
+      chunk = m_chunks.at(key);
+    }
+
+    serialization::save_game_chunk(*chunk, m_world_metadata.id);
+
+    {
+      const std::scoped_lock lock{m_mutex};
+      const auto it = m_chunks.find(key);
+
+      // Write again if a newer version was pushed while saving
+      if (it->second != chunk)
+      {
+        continue;
+      }
+
+      m_chunks.erase(it);
+    }
+
+    m_condition.notify_all();
+    return;
+  }
+}
+}  // namespace dl
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "./chunk.hpp"
+#include "core/maths/vector.hpp"
+#include "core/thread_pool.hpp"
+
+namespace dl
+{
+struct WorldMetadata;
+
+// Write-behind queue that saves chunks in a background thread. Chunks are kept
+// in the queue until they are written, so a chunk queued several times is only
+// written with its latest version and can be loaded back before reaching the disk.
+class ChunkSaveQueue
+{
+ public:
+  ChunkSaveQueue(const WorldMetadata& world_metadata);
+  ~ChunkSaveQueue();
+
+  ChunkSaveQueue(const ChunkSaveQueue&) = delete;
+  ChunkSaveQueue& operator=(const ChunkSaveQueue&) = delete;
+
+  void push(std::unique_ptr<Chunk> chunk);
+
+  // Copy of a chunk that wasn't written yet, null if the chunk is not in the queue
+  std::unique_ptr<Chunk> get(const Vector3i& position) const;
+
+  // Blocks until all queued chunks are written
+  void flush();
+
+  std::size_t size() const;
+
+ private:
+  const WorldMetadata& m_world_metadata;
+  mutable std::mutex m_mutex{};
+  std::condition_variable m_condition{};
+  std::unordered_map<uint64_t, std::shared_ptr<const Chunk>> m_chunks{};
+  ThreadPool m_thread_pool{};
+
+  void m_save(const uint64_t key);
+};
+}  // namespace dl
@@ -6,10 +6,12 @@
 #include <algorithm>
 #include <cmath>
 
+#include "config.hpp"
 #include "constants.hpp"
 #include "core/maths/random.hpp"
 #include "core/maths/utils.hpp"
 #include "world/chunk.hpp"
+#include "world/generators/chunk_noise_cache.hpp"
 #include "world/generators/tile_procedure.hpp"
 #include "world/generators/tile_procedure_manager.hpp"
 #include "world/generators/utils.hpp"
@@ -18,6 +20,17 @@
 
 namespace dl
 {
+namespace
+{
+constexpr int height_modifier_seed_offset = 94;
+
+ChunkNoiseCache& get_noise_cache()
+{
+  static ChunkNoiseCache noise_cache{config::world::noise_cache_size};
+  return noise_cache;
+}
+}  // namespace
+
 ChunkGenerator::ChunkGenerator(const WorldMetadata& world_metadata)
     : size(world::chunk_size), m_world_metadata(world_metadata)
 {
@@ -25,12 +38,19 @@ ChunkGenerator::ChunkGenerator(const WorldMetadata& world_metadata)
 
 void ChunkGenerator::generate(const int seed, const Vector3i& offset)
 {
+  // Random decisions only depend on the seed and the chunk position, so chunks are the
+  // same no matter which thread generates them or in which order
+  const random::ScopedSeed scoped_seed{random::make_key(seed, offset)};
+
   m_generate_noise_data(seed, offset);
 
   chunk = std::make_unique<Chunk>(offset, true);
   chunk->tiles.set_size(size);
 
   auto terrain = std::vector<BlockType>(m_padded_size.x * m_padded_size.y * size.z);
+  auto heights = std::vector<int>(m_padded_size.x * m_padded_size.y);
+
+  m_sample_height_map(offset, heights);
 
   for (int j = 0; j < m_padded_size.y; ++j)
   {
@@ -39,7 +59,7 @@ void ChunkGenerator::generate(const int seed, const Vector3i& offset)
       const auto world_position = offset + Vector3i{i, j, 0};
 
       const auto biome = m_sample_biome(world_position);
-      int k = m_sample_height_map(world_position);
+      int k = heights[j * m_padded_size.x + i];
 
       const auto height_modifier = height_modifier_map[j * m_padded_size.x + i];
 
@@ -138,8 +158,6 @@ void ChunkGenerator::generate(const int seed, const Vector3i& offset)
 
   chunk->tiles.compute_visibility();
 
-  TileProcedureManager::init();
-
   auto procedure = GenerateTerrainChunk();
 
   for (int k = 0; k < size.z; ++k)
@@ -163,23 +181,91 @@ void ChunkGenerator::set_size(const Vector3i& size)
 void ChunkGenerator::m_generate_noise_data(const int seed, const Vector3i& offset)
 {
   height_modifier_map.resize(m_padded_size.x * m_padded_size.y);
-  vegetation_type.resize(size.x * size.y);
-  vegetation_density.resize(size.x * size.y);
+
+  auto& noise_cache = get_noise_cache();
+  auto noise = noise_cache.get(offset, seed);
+
+  if (noise == nullptr || noise->size != Vector2i{size.x, size.y})
+  {
+    noise = m_create_chunk_noise(seed, offset);
+    noise_cache.put(offset, seed, noise);
+  }
+
+  vegetation_type = noise->vegetation_type;
+  vegetation_density = noise->vegetation_density;
+
+  // The padded height modifier map is made of this chunk noise and the borders of the
+  // neighbours, borders are copied from the cache or generated on their own
+  for (int j = -1; j <= 1; ++j)
+  {
+    for (int i = -1; i <= 1; ++i)
+    {
+      const int x = i < 0 ? 0 : (i == 0 ? m_padding : size.x + m_padding);
+      const int y = j < 0 ? 0 : (j == 0 ? m_padding : size.y + m_padding);
+      const int width = i == 0 ? size.x : m_padding;
+      const int height = j == 0 ? size.y : m_padding;
+      const Vector3i neighbor_offset{offset.x + i * size.x, offset.y + j * size.y, offset.z};
+
+      auto neighbor_noise = i == 0 && j == 0 ? noise : noise_cache.get(neighbor_offset, seed);
+
+      if (neighbor_noise != nullptr && neighbor_noise->size == Vector2i{size.x, size.y})
+      {
+        for (int y0 = y; y0 < y + height; ++y0)
+        {
+          const int neighbor_y = offset.y - m_padding + y0 - neighbor_offset.y;
+          const int neighbor_x = offset.x - m_padding + x - neighbor_offset.x;
+          const auto source = neighbor_noise->height_modifier.begin() + neighbor_y * size.x + neighbor_x;
+          std::copy(source, source + width, height_modifier_map.begin() + y0 * m_padded_size.x + x);
+        }
+
+        continue;
+      }
+
+      std::vector<float> border(width * height);
+      utils::generate_height_modifier_map(border.data(),
+                                          offset.x - m_padding + x,
+                                          offset.y - m_padding + y,
+                                          width,
+                                          height,
+                                          seed + height_modifier_seed_offset);
+
+      for (int y0 = 0; y0 < height; ++y0)
+      {
+        std::copy(border.begin() + y0 * width,
+                  border.begin() + (y0 + 1) * width,
+                  height_modifier_map.begin() + (y + y0) * m_padded_size.x + x);
+      }
+    }
+  }
+}
+
+std::shared_ptr<const ChunkNoise> ChunkGenerator::m_create_chunk_noise(const int seed, const Vector3i& offset) const
+{
+  // Node trees are built once per thread
+  thread_local const FastNoise::SmartNode<> vegetation_type_noise
+      = FastNoise::NewFromEncodedNodeTree("DAADAAAA7FG4Pw0AAwAAAAAAAEApAAAAAAA/AAAAAAAAAAAgQA==");
+  thread_local const FastNoise::SmartNode<> vegetation_density_noise
+      = FastNoise::NewFromEncodedNodeTree("DQACAAAAexROQCkAAFK4Hj8AmpkZPw==");
+
+  auto noise = std::make_shared<ChunkNoise>();
+  noise->size = Vector2i{size.x, size.y};
+  noise->height_modifier.resize(size.x * size.y);
+  noise->vegetation_type.resize(size.x * size.y);
+  noise->vegetation_density.resize(size.x * size.y);
 
   // Height modifier
   utils::generate_height_modifier_map(
-      height_modifier_map.data(), offset.x - 1, offset.y - 1, m_padded_size.x, m_padded_size.y, seed + 94);
+      noise->height_modifier.data(), offset.x, offset.y, size.x, size.y, seed + height_modifier_seed_offset);
 
   // Vegetation type lookup
-  FastNoise::SmartNode<> vegetation_type_noise
-      = FastNoise::NewFromEncodedNodeTree("DAADAAAA7FG4Pw0AAwAAAAAAAEApAAAAAAA/AAAAAAAAAAAgQA==");
-  vegetation_type_noise->GenUniformGrid2D(vegetation_type.data(), offset.x, offset.y, size.x, size.y, 0.05f, seed + 30);
+  vegetation_type_noise->GenUniformGrid2D(
+      noise->vegetation_type.data(), offset.x, offset.y, size.x, size.y, 0.05f, seed + 30);
 
   // Vegetation density lookup
-  FastNoise::SmartNode<> vegetation_density_noise
-      = FastNoise::NewFromEncodedNodeTree("DQACAAAAexROQCkAAFK4Hj8AmpkZPw==");
   vegetation_density_noise->GenUniformGrid2D(
-      vegetation_density.data(), offset.x, offset.y, size.x, size.y, 0.05f, seed + 50);
+      noise->vegetation_density.data(), offset.x, offset.y, size.x, size.y, 0.05f, seed + 50);
+
+  return noise;
 }
 
 void ChunkGenerator::m_select_tile(std::vector<BlockType>& terrain, const int x, const int y, const int z)
@@ -703,6 +789,143 @@ bool ChunkGenerator::m_has_neighbor(
   return false;
 }
 
+void ChunkGenerator::m_sample_height_map(const Vector3i& offset, std::vector<int>& heights)
+{
+  if (m_height_map_sampler == Sampler::Bicubic)
+  {
+    m_sample_height_map_bicubic(offset, heights);
+    return;
+  }
+
+  for (int j = 0; j < m_padded_size.y; ++j)
+  {
+    for (int i = 0; i < m_padded_size.x; ++i)
+    {
+      heights[j * m_padded_size.x + i] = m_sample_height_map(offset + Vector3i{i, j, 0});
+    }
+  }
+}
+
+void ChunkGenerator::m_sample_height_map_bicubic(const Vector3i& offset, std::vector<int>& heights)
+{
+  // Catmull-Rom weights of one axis, all the tiles of a row share the weights of their
+  // column and all the tiles of a column share the weights of their row
+  struct AxisSample
+  {
+    int cell = 0;
+    bool inside = false;
+    std::array<double, 4> weights{};
+  };
+
+  const auto get_axis_samples = [](const int origin, const int count, const int map_size) {
+    std::vector<AxisSample> axis_samples(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+      auto position = (origin + i) / static_cast<double>(world::map_to_tiles);
+      auto& sample = axis_samples[i];
+      sample.inside = static_cast<int>(position) >= 0 && static_cast<int>(position) < map_size;
+
+      // Subtract 0.5 to center the sample
+      position -= 0.5;
+
+      const auto cell = std::floor(position);
+      const auto t = position - cell;
+      const auto t2 = t * t;
+      const auto t3 = t2 * t;
+
+      sample.cell = static_cast<int>(cell);
+      sample.weights[0] = 0.5 * (-1.0 * t3 + 2.0 * t2 - t);
+      sample.weights[1] = 0.5 * (3.0 * t3 - 5.0 * t2 + 2.0);
+      sample.weights[2] = 0.5 * (-3.0 * t3 + 4.0 * t2 + t);
+      sample.weights[3] = 0.5 * (t3 - t2);
+    }
+
+    return axis_samples;
+  };
+
+  const auto& world_size = m_world_metadata.world_size;
+  const auto columns = get_axis_samples(offset.x, m_padded_size.x, world_size.x);
+  const auto rows = get_axis_samples(offset.y, m_padded_size.y, world_size.y);
+
+  // Copy the height map cells used by the chunk once, cells outside the map are zero
+  const int window_x = columns.front().cell - 1;
+  const int window_y = rows.front().cell - 1;
+  const int window_width = columns.back().cell + 3 - window_x;
+  const int window_height = rows.back().cell + 3 - window_y;
+  std::vector<float> window(window_width * window_height, 0.0f);
+
+  for (int j = 0; j < window_height; ++j)
+  {
+    const int y = window_y + j;
+
+    if (y < 0 || y >= world_size.y)
+    {
+      continue;
+    }
+
+    for (int i = 0; i < window_width; ++i)
+    {
+      const int x = window_x + i;
+
+      if (x >= 0 && x < world_size.x)
+      {
+        window[j * window_width + i] = m_world_metadata.height_map[utils::array_index(x, y, world_size.x)];
+      }
+    }
+  }
+
+  // Interpolate each window row horizontally for every column of the chunk
+  std::vector<float> horizontal(window_height * m_padded_size.x);
+
+  for (int j = 0; j < window_height; ++j)
+  {
+    const float* window_row = window.data() + j * window_width;
+    float* horizontal_row = horizontal.data() + j * m_padded_size.x;
+
+    for (int i = 0; i < m_padded_size.x; ++i)
+    {
+      const auto& column = columns[i];
+      const float* samples = window_row + column.cell - 1 - window_x;
+
+      horizontal_row[i] = column.weights[0] * samples[0] + column.weights[1] * samples[1]
+                          + column.weights[2] * samples[2] + column.weights[3] * samples[3];
+    }
+  }
+
+  // Interpolate vertically
+  for (int j = 0; j < m_padded_size.y; ++j)
+  {
+    const auto& row = rows[j];
+    int* heights_row = heights.data() + j * m_padded_size.x;
+
+    if (!row.inside)
+    {
+      std::fill(heights_row, heights_row + m_padded_size.x, 0);
+      continue;
+    }
+
+    const float* row_0 = horizontal.data() + (row.cell - 1 - window_y) * m_padded_size.x;
+    const float* row_1 = row_0 + m_padded_size.x;
+    const float* row_2 = row_1 + m_padded_size.x;
+    const float* row_3 = row_2 + m_padded_size.x;
+
+    for (int i = 0; i < m_padded_size.x; ++i)
+    {
+      if (!columns[i].inside)
+      {
+        heights_row[i] = 0;
+        continue;
+      }
+
+      const auto interpolated_value = row.weights[0] * row_0[i] + row.weights[1] * row_1[i]
+                                      + row.weights[2] * row_2[i] + row.weights[3] * row_3[i];
+
+      heights_row[i] = static_cast<int>(std::clamp(interpolated_value, 0.0, 1.0) * (size.z - 1));
+    }
+  }
+}
+
 int ChunkGenerator::m_sample_height_map(const Vector3i& world_position)
 {
   Vector2 height_map_position = utils::world_to_map(world_position);
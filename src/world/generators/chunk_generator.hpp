@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "core/maths/vector.hpp"
@@ -9,6 +10,7 @@
 namespace dl
 {
 struct Chunk;
+struct ChunkNoise;
 struct WorldMetadata;
 
 class ChunkGenerator
@@ -52,7 +54,11 @@ class ChunkGenerator
   Sampler m_height_map_sampler = Sampler::Bicubic;
 
   void m_generate_noise_data(const int seed, const Vector3i& offset);
+  std::shared_ptr<const ChunkNoise> m_create_chunk_noise(const int seed, const Vector3i& offset) const;
 
+  // Samples the height map for the whole padded chunk
+  void m_sample_height_map(const Vector3i& offset, std::vector<int>& heights);
+  void m_sample_height_map_bicubic(const Vector3i& offset, std::vector<int>& heights);
   int m_sample_height_map(const Vector3i& world_position);
 
   BiomeType m_sample_biome(const Vector3i& world_position);
@@ -0,0 +1,50 @@
+#include "./chunk_noise_cache.hpp"
+
+namespace dl
+{
+ChunkNoiseCache::ChunkNoiseCache(const std::size_t capacity) : m_capacity(capacity) {}
+
+std::shared_ptr<const ChunkNoise> ChunkNoiseCache::get(const Vector3i& chunk_position, const int seed)
+{
+  const std::scoped_lock lock{m_mutex};
+  const auto it = m_index.find(Key{chunk_position.x, chunk_position.y, seed});
+
+  if (it == m_index.end())
+  {
+    ++m_misses;
+    return nullptr;
+  }
+
+  ++m_hits;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->second;
+}
+
+void ChunkNoiseCache::put(const Vector3i& chunk_position, const int seed, std::shared_ptr<const ChunkNoise> noise)
+{
+  if (m_capacity == 0)
+  {
+    return;
+  }
+
+  const Key key{chunk_position.x, chunk_position.y, seed};
+  const std::scoped_lock lock{m_mutex};
+  const auto it = m_index.find(key);
+
+  if (it != m_index.end())
+  {
+    it->second->second = std::move(noise);
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return;
+  }
+
+  m_entries.emplace_front(key, std::move(noise));
+  m_index[key] = m_entries.begin();
+
+  if (m_entries.size() > m_capacity)
+  {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+  }
+}
+}  // namespace dl
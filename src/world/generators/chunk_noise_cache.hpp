@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/maths/vector.hpp"
+
+namespace dl
+{
+// Noise generated for the tiles of a chunk, without padding
+struct ChunkNoise
+{
+  Vector2i size{};
+  std::vector<float> height_modifier{};
+  std::vector<float> vegetation_type{};
+  std::vector<float> vegetation_density{};
+};
+
+// Least recently used cache of chunk noise shared by all chunk generators, so that
+// regenerated chunks and the borders of neighbouring chunks don't compute noise again
+class ChunkNoiseCache
+{
+ public:
+  ChunkNoiseCache(const std::size_t capacity);
+
+  std::shared_ptr<const ChunkNoise> get(const Vector3i& chunk_position, const int seed);
+  void put(const Vector3i& chunk_position, const int seed, std::shared_ptr<const ChunkNoise> noise);
+
+  uint64_t get_hits() const { return m_hits; }
+  uint64_t get_misses() const { return m_misses; }
+
+ private:
+  struct Key
+  {
+    int x = 0;
+    int y = 0;
+    int seed = 0;
+
+    bool operator==(const Key& rhs) const { return x == rhs.x && y == rhs.y && seed == rhs.seed; }
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const
+    {
+      const uint64_t position
+          = (static_cast<uint64_t>(static_cast<uint32_t>(key.x)) << 32) | static_cast<uint32_t>(key.y);
+      return std::hash<uint64_t>{}(position) ^ (std::hash<int>{}(key.seed) << 1);
+    }
+  };
+
+  using Entry = std::pair<Key, std::shared_ptr<const ChunkNoise>>;
+
+  std::size_t m_capacity = 0;
+  std::mutex m_mutex{};
+  // Most recently used entries first
+  std::list<Entry> m_entries{};
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index{};
+  std::atomic<uint64_t> m_hits = 0;
+  std::atomic<uint64_t> m_misses = 0;
+};
+}  // namespace dl
@@ -4,16 +4,22 @@
 #include <heman.h>
 #include <spdlog/spdlog.h>
 
-#include <limits>
-#include <queue>
+#include <numeric>
 
 #include "core/json.hpp"
 #include "core/maths/utils.hpp"
+#include "core/parallel.hpp"
 #include "core/timer.hpp"
 #include "world/generators/terrain_type.hpp"
 #include "world/generators/utils.hpp"
 #include "world/point.hpp"
 
+namespace
+{
+// Rows processed by each parallel task in the per pixel passes
+constexpr int rows_per_task = 32;
+}  // namespace
+
 namespace dl
 {
 IslandGenerator::IslandGenerator(const Vector3i& size) : size(size)
@@ -30,13 +36,19 @@ void IslandGenerator::generate(const int seed)
   spdlog::info("WIDTH: {}", size.x);
   spdlog::info("HEIGHT: {}\n", size.y);
 
+  stage_timings.clear();
+
   Timer timer{};
   timer.start();
 
   spdlog::info("Generating height map...");
 
   m_compute_maps(seed);
+
+  Timer stage_timer{};
+  stage_timer.start();
   m_generate_biomes();
+  m_add_stage_timing("Biomes", stage_timer);
 
   spdlog::info("Adjusting islands...");
 
@@ -67,6 +79,13 @@ void IslandGenerator::set_size(const Vector3i& size)
   this->size = size;
 }
 
+void IslandGenerator::m_add_stage_timing(const std::string& name, Timer& timer)
+{
+  timer.stop();
+  timer.print(name);
+  stage_timings.push_back(StageTiming{name, timer.count<std::chrono::microseconds>() / 1000.0});
+}
+
 void IslandGenerator::m_load_params(const std::string& filepath)
 {
   JSON json{filepath};
@@ -93,11 +112,33 @@ void IslandGenerator::m_compute_maps(const int seed)
   std::vector<float> mountain_map(size.x * size.y);
   std::vector<float> control_map(size.x * size.y);
 
-  utils::generate_silhouette_map(silhouette_map.data(), size.x / -2, size.y / -2, size.x, size.y, island_params, seed);
-  utils::generate_mountain_map(mountain_map.data(), size.x / -2, size.y / -2, size.x, size.y, island_params, seed + 47);
-  utils::generate_control_map(control_map.data(), size.x / -2, size.y / -2, size.x, size.y, island_params, seed + 13);
-  utils::generate_humidity_map(humidity_map.data(), size.x, size.y, island_params, seed + 470);
-  utils::generate_temperature_map(temperature_map.data(), size.x, size.y, island_params, seed + 130);
+  Timer timer{};
+  timer.start();
+
+  // The noise layers don't depend on each other
+  parallel::invoke({
+      [this, &silhouette_map, seed]
+      {
+        utils::generate_silhouette_map(
+            silhouette_map.data(), size.x / -2, size.y / -2, size.x, size.y, island_params, seed);
+      },
+      [this, &mountain_map, seed]
+      {
+        utils::generate_mountain_map(
+            mountain_map.data(), size.x / -2, size.y / -2, size.x, size.y, island_params, seed + 47);
+      },
+      [this, &control_map, seed]
+      {
+        utils::generate_control_map(
+            control_map.data(), size.x / -2, size.y / -2, size.x, size.y, island_params, seed + 13);
+      },
+      [this, seed] { utils::generate_humidity_map(humidity_map.data(), size.x, size.y, island_params, seed + 470); },
+      [this, seed]
+      { utils::generate_temperature_map(temperature_map.data(), size.x, size.y, island_params, seed + 130); },
+  });
+
+  m_add_stage_timing("Noise layers", timer);
+  timer.start();
 
   const float half_size_x = size.x / 2.0f;
   const float half_size_y = size.y / 2.0f;
@@ -105,130 +146,137 @@ void IslandGenerator::m_compute_maps(const int seed)
   const float gradient_diameter = size.x * 0.625f;
   const float gradient_diameter_squared = gradient_diameter * gradient_diameter;
 
-  for (int j = 0; j < size.y; ++j)
+  const auto combine_rows = [&](const int begin, const int end)
   {
-    for (int i = 0; i < size.x; ++i)
+    for (int j = begin; j < end; ++j)
     {
-      const auto array_index = j * size.x + i;
+      for (int i = 0; i < size.x; ++i)
+      {
+        const auto array_index = j * size.x + i;
 
-      // Apply falloff to the silhouette
-      const float distance_x_squared = (half_size_x - i) * (half_size_x - i);
-      const float distance_y_squared = (half_size_y - j) * (half_size_y - j);
+        // Apply falloff to the silhouette
+        const float distance_x_squared = (half_size_x - i) * (half_size_x - i);
+        const float distance_y_squared = (half_size_y - j) * (half_size_y - j);
 
-      const float gradient = ((distance_x_squared + distance_y_squared) * 2.0f / gradient_diameter_squared);
+        const float gradient = ((distance_x_squared + distance_y_squared) * 2.0f / gradient_diameter_squared);
 
-      silhouette_map[array_index] -= gradient;
-      silhouette_map[array_index] = std::clamp(silhouette_map[array_index], 0.0f, 1.0f);
+        silhouette_map[array_index] -= gradient;
+        silhouette_map[array_index] = std::clamp(silhouette_map[array_index], 0.0f, 1.0f);
 
-      const double silhouette_value = silhouette_map[array_index];
-      double map_value;
+        const double silhouette_value = silhouette_map[array_index];
+        double map_value;
 
-      if (silhouette_value < 0.3f)
-      {
-        map_value = utils::interpolate<double>(0.0, 0.3, 0.0, 0.16, silhouette_value);
-      }
-      else if (silhouette_value < 0.5f)
-      {
-        map_value = utils::interpolate<double>(0.3, 0.5, 0.16, 0.35, silhouette_value);
-      }
-      else
-      {
-        map_value = utils::interpolate<double>(0.5, 1.0, 0.35, 0.734, silhouette_value);
-      }
+        if (silhouette_value < 0.3f)
+        {
+          map_value = utils::interpolate<double>(0.0, 0.3, 0.0, 0.16, silhouette_value);
+        }
+        else if (silhouette_value < 0.5f)
+        {
+          map_value = utils::interpolate<double>(0.3, 0.5, 0.16, 0.35, silhouette_value);
+        }
+        else
+        {
+          map_value = utils::interpolate<double>(0.5, 1.0, 0.35, 0.734, silhouette_value);
+        }
 
-      // Apply mountain map via control map
-      if (map_value > 0.02)
-      {
-        double mountain_value = mountain_map[array_index];
-        double control_value = control_map[array_index];
-        const auto noise_influence = std::min(1.0, silhouette_value + 0.5);
-        map_value = std::max(map_value, map_value + (mountain_value * control_value * 2.0 * noise_influence));
-      }
+        // Apply mountain map via control map
+        if (map_value > 0.02)
+        {
+          double mountain_value = mountain_map[array_index];
+          double control_value = control_map[array_index];
+          const auto noise_influence = std::min(1.0, silhouette_value + 0.5);
+          map_value = std::max(map_value, map_value + (mountain_value * control_value * 2.0 * noise_influence));
+        }
 
-      map_value = std::clamp(map_value, 0.0, 1.0);
+        map_value = std::clamp(map_value, 0.0, 1.0);
 
-      height_map[array_index] = map_value;
+        height_map[array_index] = map_value;
 
-      // Create land mask
-      if (map_value > 0.02)
-      {
-        island_mask[array_index] = TerrainType::Land;
-      }
-      else
-      {
-        island_mask[array_index] = TerrainType::None;
+        // Create land mask
+        if (map_value > 0.02)
+        {
+          island_mask[array_index] = TerrainType::Land;
+        }
+        else
+        {
+          island_mask[array_index] = TerrainType::None;
+        }
       }
     }
-  }
+  };
 
-  // Floodfill from the borders in order to get a mask of the sea
-  bool has_flooded_ocean = false;
+  parallel::for_each_range(size.y, rows_per_task, combine_rows);
 
-  for (int j = 0; j < size.y && !has_flooded_ocean; ++j)
-  {
-    for (int i = 0; i < size.x && !has_flooded_ocean; ++i)
-    {
-      if (i != 0 && j != 0)
-      {
-        continue;
-      }
+  m_add_stage_timing("Height map", timer);
+  timer.start();
 
-      const auto value = island_mask[j * size.x + i];
+  std::vector<uint32_t> labels(size.x * size.y);
 
-      if (value == TerrainType::None)
-      {
-        if (j == 0 || i == 0)
-        {
-          m_flood_fill(island_mask, i, j, static_cast<int>(TerrainType::Water));
-          has_flooded_ocean = true;
-        }
-      }
-    }
+  // Label the water in order to find the sea, which is the first water body touching the top or left border
+  m_label_components([](const int value) { return value == TerrainType::None; }, labels);
+
+  uint32_t sea_label = 0;
+
+  for (int i = 0; i < size.x && sea_label == 0; ++i)
+  {
+    sea_label = labels[i];
+  }
+
+  for (int j = 1; j < size.y && sea_label == 0; ++j)
+  {
+    sea_label = labels[j * size.x];
   }
 
   // Replace inland water with grass
-  for (int j = 0; j < size.y; ++j)
+  for (auto i = 0; i < size.x * size.y; ++i)
   {
-    for (int i = 0; i < size.x; ++i)
+    if (island_mask[i] == TerrainType::None)
     {
-      if (island_mask[j * size.x + i] == TerrainType::None)
-      {
-        island_mask[j * size.x + i] = TerrainType::Land;
-      }
+      island_mask[i] = labels[i] == sea_label ? TerrainType::Water : TerrainType::Land;
     }
   }
 
-  // Generate a mask with only the islands we are interested
-  auto islands = m_get_islands(island_mask, 2);
+  m_add_stage_timing("Sea detection", timer);
+  timer.start();
 
-  auto heman_island_mask_image = heman_image_create(size.x, size.y, 1);
-  auto heman_island_mask = heman_image_data(heman_island_mask_image);
+  // Keep only the largest islands, ties are broken by the order the islands appear in the map
+  const uint32_t islands_to_keep = 2;
+  const auto islands = m_label_components([](const int value) { return value != TerrainType::Water; }, labels);
 
-  for (auto i = 0; i < size.x * size.y; ++i)
-  {
-    heman_island_mask[i] = 1.0f;
-  }
+  std::vector<uint32_t> islands_by_area(islands.size() - 1);
+  std::iota(islands_by_area.begin(), islands_by_area.end(), 1);
+  std::stable_sort(islands_by_area.begin(),
+                   islands_by_area.end(),
+                   [&islands](const uint32_t lhs, const uint32_t rhs)
+                   { return islands[lhs].area > islands[rhs].area; });
 
-  for (const auto& island : islands)
+  std::vector<bool> kept_islands(islands.size(), false);
+
+  for (uint32_t i = 0; i < islands_to_keep && i < islands_by_area.size(); ++i)
   {
-    for (auto i = 0; i < size.x * size.y; ++i)
-    {
-      if (island.mask[i] == TerrainType::Land)
-      {
-        heman_island_mask[i] = 0.0f;
-      }
-    }
+    kept_islands[islands_by_area[i]] = true;
   }
 
+  auto heman_island_mask_image = heman_image_create(size.x, size.y, 1);
+  auto heman_island_mask = heman_image_data(heman_island_mask_image);
+
   // Remove smaller islands from the height map
   for (auto i = 0; i < size.x * size.y; ++i)
   {
-    if (heman_island_mask[i] == 1.0f)
+    if (kept_islands[labels[i]])
+    {
+      heman_island_mask[i] = 0.0f;
+    }
+    else
     {
+      heman_island_mask[i] = 1.0f;
       height_map[i] = 0.0f;
     }
   }
 
+  m_add_stage_timing("Island extraction", timer);
+  timer.start();
+
   // Generate an Unsigned Distance Field relative to the distance to the sea
   auto distance_field = heman_distance_create_df(heman_island_mask_image);
   memcpy(sea_distance_field.data(), heman_image_data(distance_field), size.x * size.y * sizeof(float));
@@ -236,265 +284,192 @@ void IslandGenerator::m_compute_maps(const int seed)
   heman_image_destroy(heman_island_mask_image);
 
   // Combine distance field with humidity map (less humidity the further from the sea)
-  for (auto i = 0; i < size.x * size.y; ++i)
-  {
-    humidity_map[i] = humidity_map[i] - sea_distance_field[i];
-    humidity_map[i] = std::clamp(humidity_map[i], 0.0f, 1.0f);
-  }
+  parallel::for_each_range(size.y,
+                           rows_per_task,
+                           [this](const int begin, const int end)
+                           {
+                             for (auto i = begin * size.x; i < end * size.x; ++i)
+                             {
+                               humidity_map[i] = humidity_map[i] - sea_distance_field[i];
+                               humidity_map[i] = std::clamp(humidity_map[i], 0.0f, 1.0f);
+                             }
+                           });
+
+  m_add_stage_timing("Sea distance field", timer);
 }
 
 void IslandGenerator::m_generate_biomes()
 {
   biome_map.resize(size.x * size.y);
 
-  for (int j = 0; j < size.y; ++j)
+  // Each pixel only depends on the maps at the same position
+  const auto generate_rows = [this](const int begin, const int end)
   {
-    for (int i = 0; i < size.x; ++i)
+    for (int j = begin; j < end; ++j)
     {
-      const auto height_value = height_map[j * size.x + i];
-      const auto sea_distance_value = sea_distance_field[j * size.x + i];
-      const auto humidity_value = humidity_map[j * size.x + i];
-      const auto temperature_value = temperature_map[j * size.x + i];
-
-      if (height_value <= 0.02 && sea_distance_value <= 0.0f)
-      {
-        biome_map[j * size.x + i] = BiomeType::Sea;
-        continue;
-      }
-      if (height_value <= 0.02 && sea_distance_value > 0.0f)
+      for (int i = 0; i < size.x; ++i)
       {
-        biome_map[j * size.x + i] = BiomeType::Lake;
-        continue;
-      }
-      if (height_value < 0.054 && sea_distance_value < 0.02f && humidity_value > 0.5f)
-      {
-        biome_map[j * size.x + i] = BiomeType::Mangrove;
-        continue;
-      }
-      if (height_value < 0.055 && sea_distance_value < 0.01f)
-      {
-        biome_map[j * size.x + i] = BiomeType::Beach;
-        continue;
-      }
-      if (sea_distance_value < 0.02f && humidity_value < 0.4f)
-      {
-        biome_map[j * size.x + i] = BiomeType::Rocks;
-        continue;
-      }
-      if (height_value > 0.35 && temperature_value >= 0.5f)
-      {
-        biome_map[j * size.x + i] = BiomeType::RockMountains;
-        continue;
-      }
-      if (height_value > 0.33 && temperature_value < 0.6f)
-      {
-        biome_map[j * size.x + i] = BiomeType::PineForestMountains;
-        continue;
-      }
-      if (height_value > 0.012 && height_value < 0.275 && humidity_value < 0.18f)
-      {
-        biome_map[j * size.x + i] = BiomeType::DryPlains;
-        continue;
-      }
-      if (height_value > 0.137 && height_value < 0.196 && humidity_value >= 0.1f && humidity_value < 0.4f)
-      {
-        biome_map[j * size.x + i] = BiomeType::Meadows;
-        continue;
-      }
-      if (height_value >= 0.196 && humidity_value < 0.37f)
-      {
-        biome_map[j * size.x + i] = BiomeType::TemperateForest;
-        continue;
-      }
-      if (height_value > 0.118 && humidity_value > 0.7f)
-      {
-        biome_map[j * size.x + i] = BiomeType::Swamp;
-        continue;
-      }
-      if (height_value > 0.0118)
-      {
-        biome_map[j * size.x + i] = BiomeType::Rainforest;
-        continue;
+        const auto height_value = height_map[j * size.x + i];
+        const auto sea_distance_value = sea_distance_field[j * size.x + i];
+        const auto humidity_value = humidity_map[j * size.x + i];
+        const auto temperature_value = temperature_map[j * size.x + i];
+
+        if (height_value <= 0.02 && sea_distance_value <= 0.0f)
+        {
+          biome_map[j * size.x + i] = BiomeType::Sea;
+          continue;
+        }
+        if (height_value <= 0.02 && sea_distance_value > 0.0f)
+        {
+          biome_map[j * size.x + i] = BiomeType::Lake;
+          continue;
+        }
+        if (height_value < 0.054 && sea_distance_value < 0.02f && humidity_value > 0.5f)
+        {
+          biome_map[j * size.x + i] = BiomeType::Mangrove;
+          continue;
+        }
+        if (height_value < 0.055 && sea_distance_value < 0.01f)
+        {
+          biome_map[j * size.x + i] = BiomeType::Beach;
+          continue;
+        }
+        if (sea_distance_value < 0.02f && humidity_value < 0.4f)
+        {
+          biome_map[j * size.x + i] = BiomeType::Rocks;
+          continue;
+        }
+        if (height_value > 0.35 && temperature_value >= 0.5f)
+        {
+          biome_map[j * size.x + i] = BiomeType::RockMountains;
+          continue;
+        }
+        if (height_value > 0.33 && temperature_value < 0.6f)
+        {
+          biome_map[j * size.x + i] = BiomeType::PineForestMountains;
+          continue;
+        }
+        if (height_value > 0.012 && height_value < 0.275 && humidity_value < 0.18f)
+        {
+          biome_map[j * size.x + i] = BiomeType::DryPlains;
+          continue;
+        }
+        if (height_value > 0.137 && height_value < 0.196 && humidity_value >= 0.1f && humidity_value < 0.4f)
+        {
+          biome_map[j * size.x + i] = BiomeType::Meadows;
+          continue;
+        }
+        if (height_value >= 0.196 && humidity_value < 0.37f)
+        {
+          biome_map[j * size.x + i] = BiomeType::TemperateForest;
+          continue;
+        }
+        if (height_value > 0.118 && humidity_value > 0.7f)
+        {
+          biome_map[j * size.x + i] = BiomeType::Swamp;
+          continue;
+        }
+        if (height_value > 0.0118)
+        {
+          biome_map[j * size.x + i] = BiomeType::Rainforest;
+          continue;
+        }
       }
     }
-  }
+  };
+
+  parallel::for_each_range(size.y, rows_per_task, generate_rows);
 }
 
-void IslandGenerator::m_flood_fill(std::vector<int>& grid, const int x, const int y, const int value_to_fill)
+template <typename Predicate>
+std::vector<IslandGenerator::Component> IslandGenerator::m_label_components(const Predicate& belongs,
+                                                                            std::vector<uint32_t>& labels) const
 {
-  assert(m_valid_coordinate(x, y));
-
-  const int original_value = grid[y * size.x + x];
-  std::queue<Point<int>> coordinate_queue;
-  std::vector<int> visited(size.x * size.y, value_to_fill);
-
-  coordinate_queue.push(Point<int>(x, y));
-  grid[y * size.x + x] = value_to_fill;
+  // Union-find over provisional labels, each label points to a smaller or equal label
+  std::vector<uint32_t> parents{0};
 
-  while (!coordinate_queue.empty())
+  const auto find = [&parents](uint32_t label)
   {
-    auto coordinate = coordinate_queue.front();
-    const int x0 = coordinate.x;
-    const int y0 = coordinate.y;
-
-    coordinate_queue.pop();
-
-    // Top coordinate
-    const auto yt = y0 + 1;
-    const auto top_coordinate = yt * size.x + x0;
-    if (m_valid_coordinate(x0, yt) && grid[top_coordinate] == original_value
-        && visited[top_coordinate] == value_to_fill)
+    while (parents[label] != label)
     {
-      visited[top_coordinate] = std::numeric_limits<int>::max();
-      grid[top_coordinate] = value_to_fill;
-      coordinate_queue.push(Point<int>(x0, yt));
+      parents[label] = parents[parents[label]];
+      label = parents[label];
     }
 
-    // Bottom coordinate
-    const auto yb = y0 - 1;
-    const auto bottom_coordinate = yb * size.x + x0;
-    if (m_valid_coordinate(x0, yb) && grid[bottom_coordinate] == original_value
-        && visited[bottom_coordinate] == value_to_fill)
-    {
-      visited[bottom_coordinate] = std::numeric_limits<int>::max();
-      grid[bottom_coordinate] = value_to_fill;
-      coordinate_queue.push(Point<int>(x0, yb));
-    }
-
-    // Left coordinate
-    const auto xl = x0 - 1;
-    const auto left_coordinate = y0 * size.x + xl;
-    if (m_valid_coordinate(xl, y0) && grid[left_coordinate] == original_value
-        && visited[left_coordinate] == value_to_fill)
-    {
-      visited[left_coordinate] = std::numeric_limits<int>::max();
-      grid[left_coordinate] = value_to_fill;
-      coordinate_queue.push(Point<int>(xl, y0));
-    }
-
-    // Right coordinate
-    const auto xr = x0 + 1;
-    const auto right_coordinate = y0 * size.x + xr;
-    if (m_valid_coordinate(xr, y0) && grid[right_coordinate] == original_value
-        && visited[right_coordinate] == value_to_fill)
-    {
-      visited[right_coordinate] = std::numeric_limits<int>::max();
-      grid[right_coordinate] = value_to_fill;
-      coordinate_queue.push(Point<int>(xr, y0));
-    }
-  }
-}
-
-bool IslandGenerator::m_valid_coordinate(const int x, const int y)
-{
-  return !(x < 0 || y < 0 || x >= size.x || y >= size.y);
-}
-
-std::vector<IslandData> IslandGenerator::m_get_islands(std::vector<int>& grid, const uint32_t islands_to_keep)
-{
-  std::vector<int> mask(size.x * size.y, TerrainType::Water);
-  std::vector<IslandData> islands{};
+    return label;
+  };
 
+  // First pass, assign provisional labels from the top and left neighbours and record their equivalences
   for (int j = 0; j < size.y; ++j)
   {
     for (int i = 0; i < size.x; ++i)
     {
-      const auto tile_value = grid[j * size.x + i];
-      const auto mask_value = mask[j * size.x + i];
+      const auto index = j * size.x + i;
 
-      // Not water and not masked
-      if (tile_value != TerrainType::Water && mask_value == TerrainType::Water)
+      if (!belongs(island_mask[index]))
       {
-        const auto island_data = m_get_island(grid, mask, i, j);
-        islands.push_back(island_data);
+        labels[index] = 0;
+        continue;
       }
-    }
-  }
 
-  // Sort islands by size
-  std::sort(islands.begin(),
-            islands.end(),
-            [](const IslandData& lhs, const IslandData& rhs) { return lhs.points.size() > rhs.points.size(); });
-
-  if (islands.size() > islands_to_keep)
-  {
-    islands.resize(islands_to_keep);
-  }
+      const uint32_t top_label = j > 0 ? labels[index - size.x] : 0;
+      const uint32_t left_label = i > 0 ? labels[index - 1] : 0;
 
-  return islands;
-}
-
-IslandData IslandGenerator::m_get_island(const std::vector<int>& grid, std::vector<int>& mask, const int x, const int y)
-{
-  assert(m_valid_coordinate(x, y) && "Island coordinates are not valid");
-
-  IslandData island_data;
-  island_data.mask.resize(size.x * size.y, TerrainType::Water);
+      if (top_label == 0 && left_label == 0)
+      {
+        labels[index] = parents.size();
+        parents.push_back(parents.size());
+      }
+      else if (top_label == 0 || left_label == 0)
+      {
+        labels[index] = top_label + left_label;
+      }
+      else
+      {
+        const auto top_root = find(top_label);
+        const auto left_root = find(left_label);
+        const auto root = std::min(top_root, left_root);
 
-  std::queue<Point<int>> coord_queue;
+        parents[top_root] = root;
+        parents[left_root] = root;
+        labels[index] = root;
+      }
+    }
+  }
 
-  coord_queue.push(Point<int>(x, y));
-  island_data.top_left.x = x;
-  island_data.top_left.y = y;
-  island_data.bottom_right.x = x;
-  island_data.bottom_right.y = y;
+  // Second pass, replace provisional labels by consecutive ones in order of appearance
+  std::vector<uint32_t> final_labels(parents.size(), 0);
+  std::vector<Component> components(1);
 
-  while (!coord_queue.empty())
+  for (int j = 0; j < size.y; ++j)
   {
-    auto coord = coord_queue.front();
-
-    const int x0 = coord.x;
-    const int y0 = coord.y;
-
-    island_data.mask[y0 * size.x + x0] = TerrainType::Land;
-    island_data.points.push_back(Point<int>(x0, y0));
-    island_data.top_left.x = std::min(x0, island_data.top_left.x);
-    island_data.top_left.y = std::min(y0, island_data.top_left.y);
-    island_data.bottom_right.x = std::max(x0, island_data.bottom_right.x);
-    island_data.bottom_right.y = std::max(y0, island_data.bottom_right.y);
-
-    coord_queue.pop();
-
-    // Top coord
-    const auto yt = y0 + 1;
-    const auto top_coord = yt * size.x + x0;
-    if (m_valid_coordinate(x0, yt) && grid[top_coord] != TerrainType::Water && mask[top_coord] == TerrainType::Water)
+    for (int i = 0; i < size.x; ++i)
     {
-      mask[top_coord] = TerrainType::Land;
-      coord_queue.push(Point<int>(x0, yt));
-    }
+      const auto index = j * size.x + i;
 
-    // Bottom coord
-    const auto yb = y0 - 1;
-    const auto bottom_coord = yb * size.x + x0;
-    if (m_valid_coordinate(x0, yb) && grid[bottom_coord] != TerrainType::Water
-        && mask[bottom_coord] == TerrainType::Water)
-    {
-      mask[bottom_coord] = TerrainType::Land;
-      coord_queue.push(Point<int>(x0, yb));
-    }
+      if (labels[index] == 0)
+      {
+        continue;
+      }
 
-    // Left coord
-    const auto xl = x0 - 1;
-    const auto left_coord = y0 * size.x + xl;
-    if (m_valid_coordinate(xl, y0) && grid[left_coord] != TerrainType::Water && mask[left_coord] == TerrainType::Water)
-    {
-      mask[left_coord] = TerrainType::Land;
-      coord_queue.push(Point<int>(xl, y0));
-    }
+      auto& final_label = final_labels[find(labels[index])];
 
-    // Right coord
-    const auto xr = x0 + 1;
-    const auto right_coord = y0 * size.x + xr;
-    if (m_valid_coordinate(xr, y0) && grid[right_coord] != TerrainType::Water
-        && mask[right_coord] == TerrainType::Water)
-    {
-      mask[right_coord] = TerrainType::Land;
-      coord_queue.push(Point<int>(xr, y0));
+      if (final_label == 0)
+      {
+        final_label = components.size();
+        components.push_back(Component{0, Point<int>(i, j), Point<int>(i, j)});
+      }
+
+      auto& component = components[final_label];
+      ++component.area;
+      component.top_left.x = std::min(i, component.top_left.x);
+      component.bottom_right.x = std::max(i, component.bottom_right.x);
+      component.bottom_right.y = j;
+      labels[index] = final_label;
     }
   }
 
-  return island_data;
+  return components;
 }
 
 }  // namespace dl
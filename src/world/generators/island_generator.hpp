@@ -1,16 +1,27 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include "core/maths/vector.hpp"
 #include "world/generators/biome_type.hpp"
 #include "world/generators/island_data.hpp"
+#include "world/point.hpp"
 
 namespace dl
 {
+class Timer;
+
 class IslandGenerator
 {
  public:
+  struct StageTiming
+  {
+    std::string name{};
+    double milliseconds = 0.0;
+  };
+
   Vector3i size{1, 1, 1};
   std::vector<BiomeType> biome_map;
   std::vector<float> height_map;
@@ -19,6 +30,8 @@ class IslandGenerator
   std::vector<float> sea_distance_field;
   std::vector<int> island_mask;
   IslandNoiseParams island_params{};
+  // Duration of each stage of the last generation, in the order they ran
+  std::vector<StageTiming> stage_timings{};
 
   IslandGenerator(const Vector3i& size);
 
@@ -29,11 +42,23 @@ class IslandGenerator
   const std::string m_default_params_filepath{"./data/world/map_generators/island.json"};
 
   void m_load_params(const std::string& filepath);
+  // Stops the timer of a stage and records its duration
+  void m_add_stage_timing(const std::string& name, Timer& timer);
   void m_compute_maps(const int seed);
   void m_generate_biomes();
-  void m_flood_fill(std::vector<int>& grid, int x, int y, int value_to_fill);
-  bool m_valid_coordinate(int x, int y);
-  std::vector<IslandData> m_get_islands(std::vector<int>& grid, uint32_t islands_to_keep);
-  IslandData m_get_island(const std::vector<int>& grid, std::vector<int>& mask, int x, int y);
+
+  // Connected area of the island mask
+  struct Component
+  {
+    uint32_t area = 0;
+    Point<int> top_left;
+    Point<int> bottom_right;
+  };
+
+  // Labels the 4-connected components of the island mask values that satisfy the predicate.
+  // Pixels outside the components get the label 0, the returned components are indexed by
+  // label and the first one is empty.
+  template <typename Predicate>
+  std::vector<Component> m_label_components(const Predicate& belongs, std::vector<uint32_t>& labels) const;
 };
 }  // namespace dl
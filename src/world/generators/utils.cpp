@@ -92,6 +92,13 @@ void generate_temperature_map(float* data, int width, int height, const IslandNo
 }
 
 void generate_height_modifier_map(float* data, int x, int y, int width, int height, int seed)
+{
+  // Building the node tree is expensive compared to generating a chunk sized grid, reuse it in each thread
+  thread_local const auto height_modifier = create_height_modifier_node();
+  height_modifier->GenUniformGrid2D(data, x, y, width, height, 0.056, seed);
+}
+
+FastNoise::SmartNode<> create_height_modifier_node()
 {
   const auto simplex = FastNoise::New<FastNoise::OpenSimplex2S>();
   const auto fractal = FastNoise::New<FastNoise::FractalFBm>();
@@ -105,6 +112,6 @@ void generate_height_modifier_map(float* data, int x, int y, int width, int heig
   remap->SetSource(fractal);
   remap->SetRemap(-1.0f, 1.0f, 0.0f, 1.0f);
 
-  remap->GenUniformGrid2D(data, x, y, width, height, 0.056, seed);
+  return remap;
 }
 }  // namespace dl::utils
@@ -16,4 +16,5 @@ void generate_control_map(float* data, int x, int y, int width, int height, cons
 void generate_humidity_map(float* data, int width, int height, const IslandNoiseParams& params, int seed);
 void generate_temperature_map(float* data, int width, int height, const IslandNoiseParams& params, int seed);
 void generate_height_modifier_map(float* data, int x, int y, int width, int height, int seed);
+FastNoise::SmartNode<> create_height_modifier_node();
 }  // namespace dl::utils
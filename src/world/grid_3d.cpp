@@ -2,10 +2,54 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
+namespace
+{
+// Smallest power of two number of bits that can index a palette
+uint32_t get_index_bits(const std::size_t palette_size)
+{
+  uint32_t bits = 1;
+
+  while (bits < 32 && (std::size_t{1} << bits) < palette_size)
+  {
+    bits *= 2;
+  }
+
+  return bits;
+}
+}  // namespace
+
 namespace dl
 {
 const Cell Grid3D::null = Cell{};
 
+template <typename F>
+void Grid3D::m_update_cell(const uint32_t index, const F& update)
+{
+  if (!m_is_compact)
+  {
+    update(values[index]);
+    m_set_visible_level(index, values[index].flags);
+    return;
+  }
+
+  const uint32_t previous_palette_index = m_get_palette_index(index);
+  Cell cell = m_palette[previous_palette_index];
+  update(cell);
+
+  const uint32_t palette_index = m_find_or_add_palette_cell(cell);
+
+  if (palette_index != previous_palette_index)
+  {
+    m_set_palette_index(index, palette_index);
+    ++m_palette_counts[palette_index];
+    m_release_palette_cell(previous_palette_index);
+  }
+
+  m_set_visible_level(index, cell.flags);
+}
+
 uint32_t Grid3D::top_face_at(const int x, const int y, const int z) const
 {
   if (!m_in_bounds(x, y, z))
@@ -13,7 +57,7 @@ uint32_t Grid3D::top_face_at(const int x, const int y, const int z) const
     return 0;
   }
 
-  return values[m_index(x, y, z)].top_face;
+  return cell_at_index(m_index(x, y, z)).top_face;
 }
 
 uint32_t Grid3D::top_face_at(const Vector3i& position) const
@@ -28,7 +72,7 @@ uint32_t Grid3D::top_face_decoration_at(const int x, const int y, const int z) c
     return 0;
   }
 
-  return values[m_index(x, y, z)].top_face_decoration;
+  return cell_at_index(m_index(x, y, z)).top_face_decoration;
 }
 
 uint32_t Grid3D::top_face_decoration_at(const Vector3i& position) const
@@ -43,7 +87,7 @@ const Cell& Grid3D::cell_at(const int x, const int y, const int z) const
     return Grid3D::null;
   }
 
-  return values[m_index(x, y, z)];
+  return cell_at_index(m_index(x, y, z));
 }
 
 const Cell& Grid3D::cell_at(const Vector3i& position) const
@@ -51,6 +95,16 @@ const Cell& Grid3D::cell_at(const Vector3i& position) const
   return cell_at(position.x, position.y, position.z);
 }
 
+const Cell& Grid3D::cell_at_index(const std::size_t index) const
+{
+  if (m_is_compact)
+  {
+    return m_palette[m_get_palette_index(index)];
+  }
+
+  return values[index];
+}
+
 int Grid3D::height_at(const int x, const int y) const
 {
   if (!m_in_bounds(x, y))
@@ -88,7 +142,7 @@ void Grid3D::set(const uint32_t id, const int x, const int y, const int z)
     return;
   }
 
-  values[m_index(x, y, z)].top_face = id;
+  m_update_cell(m_index(x, y, z), [id](Cell& cell) { cell.top_face = id; });
 }
 
 void Grid3D::set(const uint32_t id, const Vector3i& position)
@@ -103,7 +157,7 @@ void Grid3D::set_top_face_decoration(const uint32_t id, const int x, const int y
     return;
   }
 
-  values[m_index(x, y, z)].top_face_decoration = id;
+  m_update_cell(m_index(x, y, z), [id](Cell& cell) { cell.top_face_decoration = id; });
 }
 
 void Grid3D::set_top_face_decoration(const uint32_t id, const Vector3i& position)
@@ -128,19 +182,31 @@ void Grid3D::set_height(const int height, const Vector2i& position)
 
 void Grid3D::set_size(const int width, const int height, const int depth)
 {
+  expand();
+
   size.x = width;
   size.y = height;
   size.z = depth;
 
   values.resize(size.x * size.y * size.z);
   height_map.resize(size.x * size.y);
+
+  m_has_visible_levels = false;
+  m_top_face_levels.clear();
+  m_front_face_levels.clear();
 }
 
 void Grid3D::set_size(const Vector3i& size)
 {
+  expand();
+
   this->size = size;
   values.resize(size.x * size.y * size.z);
   height_map.resize(size.x * size.y);
+
+  m_has_visible_levels = false;
+  m_top_face_levels.clear();
+  m_front_face_levels.clear();
 }
 
 bool Grid3D::has_flags(const CellFlag flags, const int x, const int y, const int z) const
@@ -161,8 +227,7 @@ void Grid3D::set_flags(const CellFlag flags, const int x, const int y, const int
     return;
   }
 
-  auto& cell = values[m_index(x, y, z)];
-  cell.flags |= flags;
+  m_update_cell(m_index(x, y, z), [flags](Cell& cell) { cell.flags |= flags; });
 }
 
 void Grid3D::toggle_flags(const CellFlag flags, const int x, const int y, const int z)
@@ -172,8 +237,7 @@ void Grid3D::toggle_flags(const CellFlag flags, const int x, const int y, const
     return;
   }
 
-  auto& cell = values[m_index(x, y, z)];
-  cell.flags ^= flags;
+  m_update_cell(m_index(x, y, z), [flags](Cell& cell) { cell.flags ^= flags; });
 }
 
 void Grid3D::unset_flags(const CellFlag flags, const int x, const int y, const int z)
@@ -183,8 +247,7 @@ void Grid3D::unset_flags(const CellFlag flags, const int x, const int y, const i
     return;
   }
 
-  auto& cell = values[m_index(x, y, z)];
-  cell.flags &= ~flags;
+  m_update_cell(m_index(x, y, z), [flags](Cell& cell) { cell.flags &= ~flags; });
 }
 
 void Grid3D::reset_flags(const int x, const int y, const int z)
@@ -194,86 +257,301 @@ void Grid3D::reset_flags(const int x, const int y, const int z)
     return;
   }
 
-  auto& cell = values[m_index(x, y, z)];
-  cell.flags = DL_CELL_FLAG_NONE;
+  m_update_cell(m_index(x, y, z), [](Cell& cell) { cell.flags = DL_CELL_FLAG_NONE; });
+}
+
+void Grid3D::compact()
+{
+  if (m_is_compact && m_free_palette_indices.empty())
+  {
+    return;
+  }
+
+  // Built apart since the cells may be read from the current palette
+  std::deque<Cell> palette{Cell{}};
+  std::map<CellKey, uint32_t> palette_indices{{m_get_cell_key(Cell{}), 0}};
+  std::vector<uint32_t> palette_counts{0};
+  std::vector<uint32_t> indices(size.x * size.y * size.z);
+
+  for (std::size_t i = 0; i < indices.size(); ++i)
+  {
+    const auto& cell = cell_at_index(i);
+    const auto [it, inserted] = palette_indices.emplace(m_get_cell_key(cell), palette.size());
+
+    if (inserted)
+    {
+      palette.push_back(cell);
+      palette_counts.push_back(0);
+    }
+
+    indices[i] = it->second;
+    ++palette_counts[it->second];
+  }
+
+  m_palette = std::move(palette);
+  m_palette_indices = std::move(palette_indices);
+  m_palette_counts = std::move(palette_counts);
+  m_free_palette_indices.clear();
+  m_pack_indices(indices, get_index_bits(m_palette.size()));
+
+  values.clear();
+  values.shrink_to_fit();
+  m_is_compact = true;
+}
+
+void Grid3D::expand()
+{
+  if (!m_is_compact)
+  {
+    return;
+  }
+
+  values.resize(size.x * size.y * size.z);
+
+  for (std::size_t i = 0; i < values.size(); ++i)
+  {
+    values[i] = m_palette[m_get_palette_index(i)];
+  }
+
+  m_palette.clear();
+  m_palette_indices.clear();
+  m_palette_counts.clear();
+  m_free_palette_indices.clear();
+  m_slices.clear();
+  m_index_bits = 0;
+  m_is_compact = false;
+}
+
+std::size_t Grid3D::get_memory_usage() const
+{
+  std::size_t memory_usage = values.capacity() * sizeof(Cell) + height_map.capacity() * sizeof(int)
+                             + m_palette.size() * sizeof(Cell) + m_slices.capacity() * sizeof(std::vector<uint64_t>)
+                             + m_palette_indices.size() * (sizeof(CellKey) + sizeof(uint32_t))
+                             + (m_palette_counts.capacity() + m_free_palette_indices.capacity()) * sizeof(uint32_t)
+                             + (m_top_face_levels.capacity() + m_front_face_levels.capacity()) * sizeof(uint64_t);
+
+  for (const auto& slice : m_slices)
+  {
+    memory_usage += slice.capacity() * sizeof(uint64_t);
+  }
+
+  return memory_usage;
 }
 
 void Grid3D::compute_visibility()
 {
-  for (int z = 0; z < size.z; ++z)
+  const int layer_size = size.x * size.y;
+
+  // Walk each column top down, the cell above is always known and the first
+  // solid cell of the column is its height. Cells outside of the grid are empty.
+  for (int y = 0; y < size.y; ++y)
   {
-    for (int y = 0; y < size.y; ++y)
+    for (int x = 0; x < size.x; ++x)
     {
-      for (int x = 0; x < size.x; ++x)
+      int height = -1;
+      bool is_top_empty = true;
+
+      for (int z = size.z - 1; z >= 0; --z)
       {
-        const auto block_type = block_type_at(x, y, z);
+        const uint32_t index = x + y * size.x + z * layer_size;
+        const auto block_type = cell_at_index(index).block_type;
 
         if (block_type == BlockType::None)
         {
+          is_top_empty = true;
           continue;
         }
 
-        m_set_cell_flags(x, y, z);
+        const bool is_front_empty = y + 1 >= size.y || cell_at_index(index + size.x).block_type == BlockType::None;
+        m_set_visibility_flags(index, block_type, is_top_empty, is_front_empty);
 
-        if (!has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, x, y, z))
+        if (height < 0)
         {
-          continue;
+          height = z;
         }
 
-        // Update height map if needed
-        if (height_at(x, y) < z)
-        {
-          set_height(z, x, y);
-        }
+        is_top_empty = false;
       }
+
+      height_map[x + y * size.x] = std::max(height, 0);
+    }
+  }
+
+  compute_visible_levels();
+}
+
+bool Grid3D::update_cell_visibility(
+    const int x, const int y, const int z, const BlockType top_block_type, const BlockType front_block_type)
+{
+  if (!m_in_bounds(x, y, z))
+  {
+    return false;
+  }
+
+  const auto index = m_index(x, y, z);
+  const auto& cell = cell_at_index(index);
+  const auto block_type = cell.block_type;
+
+  // A removed block leaves no visible faces behind
+  if (block_type == BlockType::None)
+  {
+    const auto block_flags
+        = DL_CELL_FLAG_TOP_FACE_VISIBLE | DL_CELL_FLAG_FRONT_FACE_VISIBLE | DL_CELL_FLAG_BLOCKS_MOVEMENT;
+    const uint8_t flags = cell.flags & ~block_flags;
+
+    if (flags == cell.flags)
+    {
+      return false;
+    }
+
+    m_update_cell(index, [flags](Cell& cell) { cell.flags = flags; });
+    return true;
+  }
+
+  const bool is_top_empty = top_block_type == BlockType::None;
+  const bool is_front_empty = front_block_type == BlockType::None;
+
+  return m_set_visibility_flags(index, block_type, is_top_empty, is_front_empty);
+}
+
+void Grid3D::update_height(const int x, const int y)
+{
+  if (!m_in_bounds(x, y))
+  {
+    return;
+  }
+
+  int height = 0;
+
+  for (int z = size.z - 1; z >= 0; --z)
+  {
+    if (cell_at_index(m_index(x, y, z)).block_type != BlockType::None)
+    {
+      height = z;
+      break;
     }
   }
+
+  height_map[x + y * size.x] = height;
 }
 
-void Grid3D::m_set_cell_flags(const int x, const int y, const int z)
+bool Grid3D::m_set_visibility_flags(const uint32_t index,
+                                    const BlockType block_type,
+                                    const bool is_top_empty,
+                                    const bool is_front_empty)
 {
-  switch (block_type_at(x, y, z))
+  const auto& cell = cell_at_index(index);
+  uint8_t flags = cell.flags & ~(DL_CELL_FLAG_TOP_FACE_VISIBLE | DL_CELL_FLAG_FRONT_FACE_VISIBLE);
+
+  if (block_type != BlockType::Decoration)
   {
-  case BlockType::Decoration:
-  case BlockType::None:
-    break;
-  default:
-    set_flags(DL_CELL_FLAG_BLOCKS_MOVEMENT, x, y, z);
-    break;
+    flags |= DL_CELL_FLAG_BLOCKS_MOVEMENT;
   }
 
   // Check visible tiles in 45deg top down view
-  // Top tile
-  if (block_type_at(x, y, z + 1) == BlockType::None)
+  if (is_top_empty)
   {
-    set_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, x, y, z);
+    flags |= DL_CELL_FLAG_TOP_FACE_VISIBLE;
   }
-  if (block_type_at(x, y + 1, z) == BlockType::None)
+  if (is_front_empty)
   {
-    set_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, x, y, z);
+    flags |= DL_CELL_FLAG_FRONT_FACE_VISIBLE;
   }
 
   // TODO: After adding view rotation, check all the other directions
-  /* if (top_face_at(x, y + 1, z) == 0) */
-  /* { */
-  /*   return true; */
-  /* } */
-  /* if (top_face_at(x + 1, y, z) == 0) */
-  /* { */
-  /*   return true; */
-  /* } */
-  /* if (top_face_at(x - 1, y, z) == 0) */
-  /* { */
-  /*   return true; */
-  /* } */
-  /* if (top_face_at(x, y - 1, z) == 0) */
-  /* { */
-  /*   return true; */
-  /* } */
-  /* if (top_face_at(x, y, z - 1) == 0) */
-  /* { */
-  /*   return true; */
-  /* } */
+
+  // Avoid adding cells to the palette of a compact grid when nothing changed
+  if (flags == cell.flags)
+  {
+    return false;
+  }
+
+  m_update_cell(index, [flags](Cell& cell) { cell.flags = flags; });
+  return true;
+}
+
+void Grid3D::compute_visible_levels()
+{
+  const uint32_t layer_size = size.x * size.y;
+  const uint32_t level_words = m_get_level_words();
+
+  m_top_face_levels.assign(layer_size * level_words, 0);
+  m_front_face_levels.assign(layer_size * level_words, 0);
+
+  for (int z = 0; z < size.z; ++z)
+  {
+    // Empty slices of a compact grid only have empty cells
+    if (m_is_compact && m_slices[z].empty())
+    {
+      continue;
+    }
+
+    const uint64_t mask = uint64_t{1} << (z % 64);
+
+    for (uint32_t column = 0; column < layer_size; ++column)
+    {
+      const auto flags = cell_at_index(z * layer_size + column).flags;
+      const uint32_t word_index = column * level_words + z / 64;
+
+      if (flags & DL_CELL_FLAG_TOP_FACE_VISIBLE)
+      {
+        m_top_face_levels[word_index] |= mask;
+      }
+      if (flags & DL_CELL_FLAG_FRONT_FACE_VISIBLE)
+      {
+        m_front_face_levels[word_index] |= mask;
+      }
+    }
+  }
+
+  m_has_visible_levels = true;
+}
+
+bool Grid3D::is_top_face_visible(const int x, const int y, const int z) const
+{
+  if (!m_in_bounds(x, y, z))
+  {
+    return false;
+  }
+
+  if (!m_has_visible_levels)
+  {
+    return cell_at_index(m_index(x, y, z)).flags & DL_CELL_FLAG_TOP_FACE_VISIBLE;
+  }
+
+  const uint32_t word_index = (x + y * size.x) * m_get_level_words() + z / 64;
+  return (m_top_face_levels[word_index] >> (z % 64)) & 1;
+}
+
+void Grid3D::m_set_visible_level(const uint32_t index, const uint8_t flags)
+{
+  if (!m_has_visible_levels)
+  {
+    return;
+  }
+
+  const uint32_t layer_size = size.x * size.y;
+  const uint32_t z = index / layer_size;
+  const uint32_t word_index = (index % layer_size) * m_get_level_words() + z / 64;
+  const uint64_t mask = uint64_t{1} << (z % 64);
+
+  if (flags & DL_CELL_FLAG_TOP_FACE_VISIBLE)
+  {
+    m_top_face_levels[word_index] |= mask;
+  }
+  else
+  {
+    m_top_face_levels[word_index] &= ~mask;
+  }
+
+  if (flags & DL_CELL_FLAG_FRONT_FACE_VISIBLE)
+  {
+    m_front_face_levels[word_index] |= mask;
+  }
+  else
+  {
+    m_front_face_levels[word_index] &= ~mask;
+  }
 }
 
 bool Grid3D::is_bottom_empty(const int x, const int y, const int z) const
@@ -313,6 +591,133 @@ bool Grid3D::has_pattern(const std::vector<uint32_t>& pattern, const Vector2i& s
   return found_pattern;
 }
 
+uint32_t Grid3D::m_get_palette_index(const uint32_t index) const
+{
+  const uint32_t slice_size = size.x * size.y;
+  const auto& slice = m_slices[index / slice_size];
+
+  if (slice.empty())
+  {
+    return 0;
+  }
+
+  const uint32_t indices_per_word = 64 / m_index_bits;
+  const uint32_t slice_index = index % slice_size;
+  const uint64_t mask = (uint64_t{1} << m_index_bits) - 1;
+
+  return (slice[slice_index / indices_per_word] >> ((slice_index % indices_per_word) * m_index_bits)) & mask;
+}
+
+void Grid3D::m_set_palette_index(const uint32_t index, const uint32_t palette_index)
+{
+  const uint32_t slice_size = size.x * size.y;
+  const uint32_t indices_per_word = 64 / m_index_bits;
+  auto& slice = m_slices[index / slice_size];
+
+  if (slice.empty())
+  {
+    if (palette_index == 0)
+    {
+      return;
+    }
+
+    slice.assign((slice_size + indices_per_word - 1) / indices_per_word, 0);
+  }
+
+  const uint32_t slice_index = index % slice_size;
+  const uint32_t shift = (slice_index % indices_per_word) * m_index_bits;
+  const uint64_t mask = (uint64_t{1} << m_index_bits) - 1;
+  auto& word = slice[slice_index / indices_per_word];
+
+  word = (word & ~(mask << shift)) | (static_cast<uint64_t>(palette_index) << shift);
+}
+
+uint32_t Grid3D::m_find_or_add_palette_cell(const Cell& cell)
+{
+  const auto key = m_get_cell_key(cell);
+  const auto it = m_palette_indices.find(key);
+
+  if (it != m_palette_indices.end())
+  {
+    return it->second;
+  }
+
+  if (!m_free_palette_indices.empty())
+  {
+    const uint32_t palette_index = m_free_palette_indices.back();
+    m_free_palette_indices.pop_back();
+    m_palette[palette_index] = cell;
+    m_palette_indices.emplace(key, palette_index);
+    return palette_index;
+  }
+
+  m_palette.push_back(cell);
+  m_palette_counts.push_back(0);
+  const uint32_t palette_index = m_palette.size() - 1;
+  m_palette_indices.emplace(key, palette_index);
+
+  if (m_palette.size() > (std::size_t{1} << m_index_bits))
+  {
+    std::vector<uint32_t> indices(size.x * size.y * size.z);
+
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+      indices[i] = m_get_palette_index(i);
+    }
+
+    m_pack_indices(indices, get_index_bits(m_palette.size()));
+  }
+
+  return palette_index;
+}
+
+void Grid3D::m_release_palette_cell(const uint32_t palette_index)
+{
+  --m_palette_counts[palette_index];
+
+  // The empty cell is always kept
+  if (m_palette_counts[palette_index] > 0 || palette_index == 0)
+  {
+    return;
+  }
+
+  m_palette_indices.erase(m_get_cell_key(m_palette[palette_index]));
+  m_free_palette_indices.push_back(palette_index);
+}
+
+Grid3D::CellKey Grid3D::m_get_cell_key(const Cell& cell)
+{
+  return CellKey{cell.top_face,
+                 cell.front_face,
+                 cell.top_face_decoration,
+                 cell.front_face_decoration,
+                 static_cast<uint32_t>(cell.flags) | (static_cast<uint32_t>(cell.block_type) << 8)};
+}
+
+void Grid3D::m_pack_indices(const std::vector<uint32_t>& palette_indices, const uint32_t index_bits)
+{
+  const uint32_t slice_size = size.x * size.y;
+
+  m_index_bits = index_bits;
+  m_slices.assign(size.z, {});
+
+  for (int z = 0; z < size.z; ++z)
+  {
+    const auto slice_begin = palette_indices.begin() + z * slice_size;
+    const auto slice_end = slice_begin + slice_size;
+
+    if (std::all_of(slice_begin, slice_end, [](const uint32_t palette_index) { return palette_index == 0; }))
+    {
+      continue;
+    }
+
+    for (uint32_t i = 0; i < slice_size; ++i)
+    {
+      m_set_palette_index(z * slice_size + i, *(slice_begin + i));
+    }
+  }
+}
+
 uint32_t Grid3D::m_index(const int x, const int y, const int z) const
 {
   return x + y * size.x + z * size.y * size.x;
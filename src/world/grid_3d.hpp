@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <deque>
+#include <map>
 #include <vector>
 
 #include "./cell.hpp"
@@ -11,6 +16,7 @@ class Grid3D
 {
  public:
   Vector3i size{};
+  // Dense cell storage, empty while the grid is compact
   std::vector<Cell> values = std::vector<Cell>(size.x * size.y * size.z);
   std::vector<int> height_map = std::vector<int>(size.x * size.y);
   static const Cell null;
@@ -24,6 +30,8 @@ class Grid3D
   uint32_t top_face_decoration_at(const Vector3i& position) const;
   const Cell& cell_at(const int x, const int y, const int z) const;
   const Cell& cell_at(const Vector3i& position) const;
+  // Cell at an index of the x + y * size.x + z * size.x * size.y layout, works in both storage modes
+  const Cell& cell_at_index(const std::size_t index) const;
   int height_at(const int x, const int y) const;
   int height_at(const Vector2i& position) const;
   BlockType block_type_at(const int x, const int y, const int z) const;
@@ -46,20 +54,144 @@ class Grid3D
   void unset_flags(const CellFlag flags, const int x, const int y, const int z);
   void reset_flags(const int x, const int y, const int z);
 
+  // Moves the cells to a palette of distinct cells indexed by bit packed values. Slices
+  // with only empty cells take no memory. The accessors keep working on a compact grid
+  // but values is released, so code that writes to values directly needs a dense grid.
+  // Compacting a compact grid packs it again without the palette cells that are no longer used.
+  void compact();
+  // Moves the cells back to the dense storage
+  void expand();
+  bool is_compact() const { return m_is_compact; }
+  // Approximate heap memory used by the cells and the height map
+  std::size_t get_memory_usage() const;
+
+  // Sets the visibility flags and the height map of all cells, cells outside of the grid are empty
   void compute_visibility();
+  // Updates the visibility flags of a single cell given the blocks above it and in front of it,
+  // which may belong to another grid when the cell is on the border. Returns true if the flags changed.
+  bool update_cell_visibility(
+      const int x, const int y, const int z, const BlockType top_block_type, const BlockType front_block_type);
+  void update_height(const int x, const int y);
+  // Rebuilds the per column index of z levels with a visible face from the visibility flags. It's kept up
+  // to date by compute_visibility and the setters, but cells written directly to values need a rebuild.
+  void compute_visible_levels();
+  bool has_visible_levels() const { return m_has_visible_levels; }
+  // Calls fn(z, is_top_face_visible, is_front_face_visible) for each cell of a column with a visible face,
+  // from the top down. Reads the flags of every cell of the column when the index wasn't computed.
+  template <typename F>
+  void for_each_visible_level(const int x, const int y, const F& fn) const;
+  bool is_top_face_visible(const int x, const int y, const int z) const;
   bool is_bottom_empty(const int x, const int y, const int z) const;
   bool has_pattern(const std::vector<uint32_t>& pattern, const Vector2i& size, const Vector3i& position) const;
 
  private:
+  using CellKey = std::array<uint32_t, 5>;
+
+  bool m_is_compact = false;
+  // Distinct cells of a compact grid, the first one is always the empty cell. A deque keeps
+  // the references returned by cell_at valid when new cells are added.
+  std::deque<Cell> m_palette{};
+  std::map<CellKey, uint32_t> m_palette_indices{};
+  // Number of cells using each palette cell, unused ones are reused by the next new cell
+  std::vector<uint32_t> m_palette_counts{};
+  std::vector<uint32_t> m_free_palette_indices{};
+  // Bits used by each palette index, always a power of two so that indices don't cross words
+  uint32_t m_index_bits = 0;
+  // Bit packed palette indices for each z slice, empty slices have no words
+  std::vector<std::vector<uint64_t>> m_slices{};
+  // Bitmasks of the z levels with a visible top or front face, one or more words per column
+  bool m_has_visible_levels = false;
+  std::vector<uint64_t> m_top_face_levels{};
+  std::vector<uint64_t> m_front_face_levels{};
+
   uint32_t m_index(const int x, const int y, const int z) const;
   bool m_in_bounds(const int x, const int y, const int z = 0) const;
   bool m_is_any_neighbour_empty(const int x, const int y, const int z) const;
-  void m_set_cell_flags(const int x, const int y, const int z);
+  bool m_set_visibility_flags(const uint32_t index,
+                              const BlockType block_type,
+                              const bool is_top_empty,
+                              const bool is_front_empty);
+  uint32_t m_get_level_words() const { return (size.z + 63) / 64; }
+  void m_set_visible_level(const uint32_t index, const uint8_t flags);
+
+  template <typename F>
+  void m_update_cell(const uint32_t index, const F& update);
+  uint32_t m_get_palette_index(const uint32_t index) const;
+  void m_set_palette_index(const uint32_t index, const uint32_t palette_index);
+  uint32_t m_find_or_add_palette_cell(const Cell& cell);
+  void m_release_palette_cell(const uint32_t palette_index);
+  static CellKey m_get_cell_key(const Cell& cell);
+  void m_pack_indices(const std::vector<uint32_t>& palette_indices, const uint32_t index_bits);
 };
 
+template <typename F>
+void Grid3D::for_each_visible_level(const int x, const int y, const F& fn) const
+{
+  if (!m_in_bounds(x, y))
+  {
+    return;
+  }
+
+  if (!m_has_visible_levels)
+  {
+    for (int z = size.z - 1; z >= 0; --z)
+    {
+      const auto flags = cell_at_index(m_index(x, y, z)).flags;
+
+      if (flags & (DL_CELL_FLAG_TOP_FACE_VISIBLE | DL_CELL_FLAG_FRONT_FACE_VISIBLE))
+      {
+        fn(z, (flags & DL_CELL_FLAG_TOP_FACE_VISIBLE) != 0, (flags & DL_CELL_FLAG_FRONT_FACE_VISIBLE) != 0);
+      }
+    }
+
+    return;
+  }
+
+  const int level_words = m_get_level_words();
+  const uint32_t offset = (x + y * size.x) * level_words;
+
+  for (int word_index = level_words - 1; word_index >= 0; --word_index)
+  {
+    const uint64_t top_face_word = m_top_face_levels[offset + word_index];
+    const uint64_t front_face_word = m_front_face_levels[offset + word_index];
+    uint64_t word = top_face_word | front_face_word;
+
+    // Highest set bit first
+    while (word != 0)
+    {
+      const int bit = std::bit_width(word) - 1;
+      const uint64_t mask = uint64_t{1} << bit;
+      fn(word_index * 64 + bit, (top_face_word & mask) != 0, (front_face_word & mask) != 0);
+      word &= ~mask;
+    }
+  }
+}
+
+template <typename Archive>
+void save(Archive& archive, const Grid3D& grid)
+{
+  if (!grid.is_compact())
+  {
+    archive(grid.size, grid.values, grid.height_map);
+    return;
+  }
+
+  // Compact grids are saved with the dense layout
+  std::vector<Cell> values(grid.size.x * grid.size.y * grid.size.z);
+
+  for (std::size_t i = 0; i < values.size(); ++i)
+  {
+    values[i] = grid.cell_at_index(i);
+  }
+
+  archive(grid.size, values, grid.height_map);
+}
+
 template <typename Archive>
-void serialize(Archive& archive, Grid3D& grid)
+void load(Archive& archive, Grid3D& grid)
 {
+  grid.expand();
   archive(grid.size, grid.values, grid.height_map);
+  grid.compute_visible_levels();
 }
 }  // namespace dl
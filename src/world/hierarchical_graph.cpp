@@ -0,0 +1,626 @@
+#include "./hierarchical_graph.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "constants.hpp"
+#include "world/a_star.hpp"
+#include "world/chunk_manager.hpp"
+#include "world/walkability_snapshot.hpp"
+
+namespace
+{
+using ChunkWalkability = dl::WalkabilitySnapshot::ChunkWalkability;
+
+constexpr int unreachable = -1;
+
+// Entrances of runs longer than this are placed at both ends of the run instead of the middle
+constexpr std::size_t max_single_entrance_length = 6;
+
+// Segments stay close to a single chunk but may have to go around large obstacles
+constexpr std::size_t max_segment_steps = dl::world::chunk_size.x * dl::world::chunk_size.y * 2;
+
+// Offsets of the neighbouring chunks in the order stored by the clusters: west, east, north and south
+const std::array<dl::Vector3i, 4> neighbor_offsets{
+    dl::Vector3i{-dl::world::chunk_size.x, 0, 0},
+    dl::Vector3i{dl::world::chunk_size.x, 0, 0},
+    dl::Vector3i{0, -dl::world::chunk_size.y, 0},
+    dl::Vector3i{0, dl::world::chunk_size.y, 0},
+};
+
+uint64_t position_key(const dl::Vector3i& position)
+{
+  // Positions are packed as 24 bits for x and y and 16 bits for z
+  const uint64_t x = static_cast<uint32_t>(position.x) & 0xFFFFFF;
+  const uint64_t y = static_cast<uint32_t>(position.y) & 0xFFFFFF;
+  const uint64_t z = static_cast<uint32_t>(position.z) & 0xFFFF;
+
+  return (x << 40) | (y << 16) | z;
+}
+
+// Octile distance, never overestimates the cost used by AStar
+int estimate_cost(const dl::Vector3i& a, const dl::Vector3i& b)
+{
+  constexpr int normal_cost = 100;
+  constexpr int diagonal_cost = normal_cost + dl::pathfinding::diagonal_cost_penalty;
+
+  const int dx = std::abs(a.x - b.x);
+  const int dy = std::abs(a.y - b.y);
+  return normal_cost * (dx + dy) + (diagonal_cost - 2 * normal_cost) * std::min(dx, dy);
+}
+
+struct Transition
+{
+  dl::Vector3i first{};
+  dl::Vector3i second{};
+};
+
+// Gets the entrances between a chunk and the next one along the x (axis 0) or y
+// (axis 1) axis. The result only depends on the pair of chunks so that both
+// clusters agree on where the entrances are.
+std::vector<Transition> get_border_entrances(const ChunkWalkability& first,
+                                             const ChunkWalkability& second,
+                                             const int axis)
+{
+  const int length = axis == 0 ? first.size.y : first.size.x;
+  const int depth = std::min(first.size.z, second.size.z);
+
+  const auto first_local = [&first, axis](const int t, const int z)
+  { return axis == 0 ? dl::Vector3i{first.size.x - 1, t, z} : dl::Vector3i{t, first.size.y - 1, z}; };
+  const auto second_local
+      = [axis](const int t, const int z) { return axis == 0 ? dl::Vector3i{0, t, z} : dl::Vector3i{t, 0, z}; };
+
+  std::vector<std::vector<Transition>> runs{};
+  std::vector<std::size_t> open_runs{};
+
+  for (int t = 0; t < length; ++t)
+  {
+    std::vector<std::size_t> extended_runs{};
+
+    for (int z = 0; z < depth; ++z)
+    {
+      const auto a = first_local(t, z);
+
+      if (!first.is_walkable(a.x, a.y, a.z))
+      {
+        continue;
+      }
+
+      // Same rules as AStar, walk straight ahead or climb a single level up or down
+      for (const int dz : {0, 1, -1})
+      {
+        const auto b = second_local(t, z + dz);
+
+        if (!second.is_walkable(b.x, b.y, b.z))
+        {
+          continue;
+        }
+
+        const Transition transition{first.position + a, second.position + b};
+
+        // Continue a run from the previous row if the heights match
+        const auto run_it = std::find_if(open_runs.begin(),
+                                         open_runs.end(),
+                                         [&runs, &transition](const std::size_t run)
+                                         {
+                                           const auto& last = runs[run].back();
+                                           return std::abs(last.first.z - transition.first.z) <= 1
+                                                  && std::abs(last.second.z - transition.second.z) <= 1;
+                                         });
+
+        if (run_it != open_runs.end())
+        {
+          runs[*run_it].push_back(transition);
+          extended_runs.push_back(*run_it);
+          open_runs.erase(run_it);
+        }
+        else
+        {
+          runs.push_back({transition});
+          extended_runs.push_back(runs.size() - 1);
+        }
+
+        break;
+      }
+    }
+
+    open_runs = std::move(extended_runs);
+  }
+
+  std::vector<Transition> entrances{};
+
+  for (const auto& run : runs)
+  {
+    if (run.size() <= max_single_entrance_length)
+    {
+      entrances.push_back(run[run.size() / 2]);
+    }
+    else
+    {
+      entrances.push_back(run.front());
+      entrances.push_back(run.back());
+    }
+  }
+
+  return entrances;
+}
+
+// Runs Dijkstra inside a chunk and returns the cost from the origin to each
+// target, or unreachable if the target can't be reached without leaving the chunk
+std::vector<int> get_costs_inside_chunk(const ChunkWalkability& chunk,
+                                        const dl::Vector3i& origin,
+                                        const std::vector<dl::Vector3i>& targets)
+{
+  using QueueItem = std::pair<int, uint32_t>;
+
+  // Reused between searches in the same thread, reset after each search
+  thread_local std::vector<int> costs{};
+  thread_local std::vector<uint32_t> touched{};
+
+  const auto& size = chunk.size;
+  const std::size_t cell_count = size.x * size.y * size.z;
+
+  if (costs.size() < cell_count)
+  {
+    costs.resize(cell_count, std::numeric_limits<int>::max());
+  }
+
+  const auto to_index = [&size](const dl::Vector3i& local)
+  { return static_cast<uint32_t>(local.x + local.y * size.x + local.z * size.x * size.y); };
+  const auto to_local = [&size](const uint32_t index)
+  {
+    return dl::Vector3i{static_cast<int>(index % size.x),
+                        static_cast<int>((index / size.x) % size.y),
+                        static_cast<int>(index / (size.x * size.y))};
+  };
+
+  std::vector<uint32_t> target_indices{};
+  target_indices.reserve(targets.size());
+
+  for (const auto& target : targets)
+  {
+    target_indices.push_back(to_index(target - chunk.position));
+  }
+
+  std::vector<int> result(targets.size(), unreachable);
+  std::size_t remaining_targets = targets.size();
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> open_set{};
+
+  const auto origin_index = to_index(origin - chunk.position);
+  costs[origin_index] = 0;
+  touched.push_back(origin_index);
+  open_set.push({0, origin_index});
+
+  while (!open_set.empty() && remaining_targets > 0)
+  {
+    const auto [cost, index] = open_set.top();
+    open_set.pop();
+
+    // Stale entry, a cheaper one was already processed
+    if (cost > costs[index])
+    {
+      continue;
+    }
+
+    for (std::size_t i = 0; i < target_indices.size(); ++i)
+    {
+      if (target_indices[i] == index && result[i] == unreachable)
+      {
+        result[i] = cost;
+        --remaining_targets;
+      }
+    }
+
+    const auto current = to_local(index);
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        if (dx == 0 && dy == 0)
+        {
+          continue;
+        }
+
+        dl::Vector3i neighbor{current.x + dx, current.y + dy, current.z};
+
+        // Climb up or down if the neighbour isn't walkable at the same level
+        if (!chunk.is_walkable(neighbor.x, neighbor.y, neighbor.z))
+        {
+          if (chunk.is_walkable(neighbor.x, neighbor.y, neighbor.z + 1))
+          {
+            ++neighbor.z;
+          }
+          else if (chunk.is_walkable(neighbor.x, neighbor.y, neighbor.z - 1))
+          {
+            --neighbor.z;
+          }
+          else
+          {
+            continue;
+          }
+        }
+
+        const int neighbor_cost = cost + dl::AStar::get_cost(current, neighbor, dx != 0 && dy != 0);
+        const auto neighbor_index = to_index(neighbor);
+
+        if (neighbor_cost < costs[neighbor_index])
+        {
+          if (costs[neighbor_index] == std::numeric_limits<int>::max())
+          {
+            touched.push_back(neighbor_index);
+          }
+
+          costs[neighbor_index] = neighbor_cost;
+          open_set.push({neighbor_cost, neighbor_index});
+        }
+      }
+    }
+  }
+
+  for (const auto index : touched)
+  {
+    costs[index] = std::numeric_limits<int>::max();
+  }
+
+  touched.clear();
+
+  return result;
+}
+}  // namespace
+
+namespace dl
+{
+HierarchicalGraph::HierarchicalGraph(std::shared_ptr<const WalkabilitySnapshot> snapshot,
+                                     const std::shared_ptr<const HierarchicalGraph>& previous)
+    : m_snapshot(std::move(snapshot))
+{
+  if (previous == nullptr)
+  {
+    return;
+  }
+
+  // Reuse the previous graph if it's built, otherwise the one it would have reused
+  std::scoped_lock lock(previous->m_base_mutex);
+  m_base = previous->m_is_built ? previous : previous->m_base;
+}
+
+void HierarchicalGraph::build() { std::call_once(m_build_flag, [this]() { m_build(); }); }
+
+std::vector<Vector3i> HierarchicalGraph::find_path(const Vector3i& from, const Vector3i& to, AStar& a_star) const
+{
+  // Waypoints are ordered from the destination to the origin
+  const auto waypoints = m_find_abstract_path(from, to);
+
+  if (waypoints.empty())
+  {
+    return {};
+  }
+
+  std::vector<Vector3i> path{};
+
+  for (std::size_t i = 0; i + 1 < waypoints.size(); ++i)
+  {
+    const auto& segment_origin = waypoints[i + 1];
+    const auto& segment_destination = waypoints[i];
+
+    if (segment_origin == segment_destination)
+    {
+      continue;
+    }
+
+    a_star.reset(segment_origin, segment_destination, max_segment_steps);
+
+    while (a_star.state == AStar::State::INITIALIZED || a_star.state == AStar::State::SEARCHING)
+    {
+      a_star.step();
+    }
+
+    // Clusters allow climbing in any direction while AStar only climbs towards
+    // the destination, in that case search the whole path instead
+    if (a_star.state != AStar::State::SUCCEEDED)
+    {
+      a_star.reset(from, to);
+
+      while (a_star.state == AStar::State::INITIALIZED || a_star.state == AStar::State::SEARCHING)
+      {
+        a_star.step();
+      }
+
+      if (a_star.state == AStar::State::SUCCEEDED)
+      {
+        return a_star.path;
+      }
+
+      return {};
+    }
+
+    // Each segment starts where the previous one ended, only keep the origin in the last one
+    const bool is_last_segment = i + 2 == waypoints.size();
+    path.insert(path.end(), a_star.path.begin(), is_last_segment ? a_star.path.end() : a_star.path.end() - 1);
+  }
+
+  return path;
+}
+
+void HierarchicalGraph::m_build()
+{
+  std::shared_ptr<const HierarchicalGraph> base = nullptr;
+
+  {
+    std::scoped_lock lock(m_base_mutex);
+    base = m_base;
+  }
+
+  for (const auto& [key, chunk] : m_snapshot->get_chunks())
+  {
+    std::array<uint32_t, 4> neighbor_revisions{};
+
+    for (std::size_t i = 0; i < neighbor_offsets.size(); ++i)
+    {
+      const auto neighbor = m_snapshot->get_chunk(chunk->position + neighbor_offsets[i]);
+      neighbor_revisions[i] = neighbor == nullptr ? 0 : neighbor->revision;
+    }
+
+    if (base != nullptr)
+    {
+      const auto it = base->m_clusters.find(key);
+
+      if (it != base->m_clusters.end() && it->second->revision == chunk->revision
+          && it->second->neighbor_revisions == neighbor_revisions)
+      {
+        m_clusters.emplace(key, it->second);
+        continue;
+      }
+    }
+
+    m_clusters.emplace(key, m_create_cluster(chunk->position, neighbor_revisions));
+  }
+
+  for (const auto& [key, cluster] : m_clusters)
+  {
+    for (uint32_t i = 0; i < cluster->entrances.size(); ++i)
+    {
+      m_nodes.emplace(position_key(cluster->entrances[i].position), NodeReference{cluster.get(), i});
+    }
+  }
+
+  std::scoped_lock lock(m_base_mutex);
+  m_is_built = true;
+  m_base = nullptr;
+}
+
+std::shared_ptr<const HierarchicalGraph::Cluster> HierarchicalGraph::m_create_cluster(
+    const Vector3i& chunk_position, const std::array<uint32_t, 4>& neighbor_revisions) const
+{
+  const auto& chunk = *m_snapshot->get_chunk(chunk_position);
+
+  auto cluster = std::make_shared<Cluster>();
+  cluster->position = chunk_position;
+  cluster->revision = chunk.revision;
+  cluster->neighbor_revisions = neighbor_revisions;
+
+  std::unordered_map<uint64_t, uint32_t> entrance_index{};
+
+  const auto add_entrance = [&cluster, &entrance_index](const Vector3i& position, const Vector3i& exit)
+  {
+    const auto [it, inserted]
+        = entrance_index.emplace(position_key(position), static_cast<uint32_t>(cluster->entrances.size()));
+
+    if (inserted)
+    {
+      cluster->entrances.push_back(Entrance{position});
+    }
+
+    cluster->entrances[it->second].exits.push_back(Exit{exit, AStar::get_cost(position, exit, false)});
+  };
+
+  for (std::size_t i = 0; i < neighbor_offsets.size(); ++i)
+  {
+    const auto neighbor = m_snapshot->get_chunk(chunk_position + neighbor_offsets[i]);
+
+    if (neighbor == nullptr)
+    {
+      continue;
+    }
+
+    const int axis = i < 2 ? 0 : 1;
+    // West and north neighbours come first in the border
+    const bool is_first = i % 2 == 0;
+    const auto transitions
+        = is_first ? get_border_entrances(*neighbor, chunk, axis) : get_border_entrances(chunk, *neighbor, axis);
+
+    for (const auto& transition : transitions)
+    {
+      if (is_first)
+      {
+        add_entrance(transition.second, transition.first);
+      }
+      else
+      {
+        add_entrance(transition.first, transition.second);
+      }
+    }
+  }
+
+  const auto entrance_count = cluster->entrances.size();
+  std::vector<Vector3i> positions{};
+  positions.reserve(entrance_count);
+
+  for (const auto& entrance : cluster->entrances)
+  {
+    positions.push_back(entrance.position);
+  }
+
+  cluster->costs.resize(entrance_count * entrance_count, unreachable);
+
+  for (std::size_t i = 0; i < entrance_count; ++i)
+  {
+    const auto costs = get_costs_inside_chunk(chunk, positions[i], positions);
+    std::copy(costs.begin(), costs.end(), cluster->costs.begin() + i * entrance_count);
+  }
+
+  return cluster;
+}
+
+const HierarchicalGraph::Cluster* HierarchicalGraph::m_get_cluster(const Vector3i& chunk_position) const
+{
+  const auto it = m_clusters.find(ChunkManager::chunk_key(chunk_position));
+
+  if (it == m_clusters.end())
+  {
+    return nullptr;
+  }
+
+  return it->second.get();
+}
+
+std::vector<Vector3i> HierarchicalGraph::m_find_abstract_path(const Vector3i& from, const Vector3i& to) const
+{
+  struct Visit
+  {
+    Vector3i position{};
+    uint64_t parent = 0;
+    int g = 0;
+    bool closed = false;
+  };
+
+  using QueueItem = std::pair<int, uint64_t>;
+
+  const auto from_chunk = ChunkManager::world_to_chunk(from);
+  const auto to_chunk = ChunkManager::world_to_chunk(to);
+  const auto origin_cluster = m_get_cluster(from_chunk);
+  const auto destination_cluster = m_get_cluster(to_chunk);
+
+  if (origin_cluster == nullptr || destination_cluster == nullptr || !m_snapshot->is_walkable(to.x, to.y, to.z))
+  {
+    return {};
+  }
+
+  const auto get_positions = [](const Cluster& cluster)
+  {
+    std::vector<Vector3i> positions{};
+    positions.reserve(cluster.entrances.size());
+
+    for (const auto& entrance : cluster.entrances)
+    {
+      positions.push_back(entrance.position);
+    }
+
+    return positions;
+  };
+
+  // Connect the origin and the destination to the entrances of their clusters.
+  // Costs inside a cluster are nearly symmetric, only climbing up and down differ,
+  // so the destination costs are computed starting from the destination.
+  const auto origin_costs
+      = get_costs_inside_chunk(*m_snapshot->get_chunk(from_chunk), from, get_positions(*origin_cluster));
+  const auto destination_costs
+      = get_costs_inside_chunk(*m_snapshot->get_chunk(to_chunk), to, get_positions(*destination_cluster));
+
+  const auto origin_key = position_key(from);
+  const auto destination_key = position_key(to);
+
+  std::unordered_map<uint64_t, Visit> visits{};
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> open_set{};
+
+  const auto relax = [&visits, &open_set, &to](const Vector3i& position, const uint64_t parent, const int g)
+  {
+    const auto key = position_key(position);
+    const auto [it, inserted] = visits.try_emplace(key, Visit{position, parent, g, false});
+
+    if (!inserted)
+    {
+      if (it->second.closed || g >= it->second.g)
+      {
+        return;
+      }
+
+      it->second.parent = parent;
+      it->second.g = g;
+    }
+
+    open_set.push({g + estimate_cost(position, to), key});
+  };
+
+  relax(from, origin_key, 0);
+
+  while (!open_set.empty())
+  {
+    const auto key = open_set.top().second;
+    open_set.pop();
+
+    auto& visit = visits.at(key);
+
+    if (visit.closed)
+    {
+      continue;
+    }
+
+    visit.closed = true;
+
+    if (key == destination_key)
+    {
+      std::vector<Vector3i> waypoints{};
+
+      for (auto current = key; current != origin_key; current = visits.at(current).parent)
+      {
+        waypoints.push_back(visits.at(current).position);
+      }
+
+      waypoints.push_back(from);
+      return waypoints;
+    }
+
+    // Copy the values we need, visits may rehash when relaxing neighbours
+    const int g = visit.g;
+
+    if (key == origin_key)
+    {
+      for (std::size_t i = 0; i < origin_costs.size(); ++i)
+      {
+        if (origin_costs[i] != unreachable)
+        {
+          relax(origin_cluster->entrances[i].position, key, g + origin_costs[i]);
+        }
+      }
+    }
+
+    // The origin may also be an entrance, in that case keep expanding it
+    const auto node_it = m_nodes.find(key);
+
+    if (node_it == m_nodes.end())
+    {
+      continue;
+    }
+
+    const auto& [cluster, entrance_index] = node_it->second;
+    const auto& entrance = cluster->entrances[entrance_index];
+    const auto entrance_count = cluster->entrances.size();
+
+    if (cluster == destination_cluster && destination_costs[entrance_index] != unreachable)
+    {
+      relax(to, key, g + destination_costs[entrance_index]);
+    }
+
+    for (std::size_t i = 0; i < entrance_count; ++i)
+    {
+      const int cost = cluster->costs[entrance_index * entrance_count + i];
+
+      if (i != entrance_index && cost != unreachable)
+      {
+        relax(cluster->entrances[i].position, key, g + cost);
+      }
+    }
+
+    for (const auto& exit : entrance.exits)
+    {
+      relax(exit.position, key, g + exit.cost);
+    }
+  }
+
+  return {};
+}
+}  // namespace dl
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/maths/vector.hpp"
+
+namespace dl
+{
+class AStar;
+class WalkabilitySnapshot;
+
+// Abstraction of a walkability snapshot for hierarchical pathfinding (HPA*).
+// Each chunk is a cluster with entrance nodes on its borders and the cost of
+// walking between every pair of entrances inside the chunk. Long paths are
+// searched on this graph first and AStar only refines the coarse route
+// between consecutive entrances.
+class HierarchicalGraph
+{
+ public:
+  // Clusters are reused from the previous graph when neither their chunk nor
+  // their neighbours changed
+  HierarchicalGraph(std::shared_ptr<const WalkabilitySnapshot> snapshot,
+                    const std::shared_ptr<const HierarchicalGraph>& previous = nullptr);
+
+  // Builds the abstraction, only the first call does any work. Safe to call from multiple threads.
+  void build();
+  bool is_built() const { return m_is_built; }
+
+  // Finds a path between two positions using the abstract graph, falling back
+  // to a regular search if the route can't be refined. The path is in the same
+  // order as AStar::path and empty if no path was found.
+  std::vector<Vector3i> find_path(const Vector3i& from, const Vector3i& to, AStar& a_star) const;
+
+ private:
+  struct Exit
+  {
+    // Position in the neighbour chunk
+    Vector3i position{};
+    int cost = 0;
+  };
+
+  struct Entrance
+  {
+    Vector3i position{};
+    std::vector<Exit> exits{};
+  };
+
+  struct Cluster
+  {
+    Vector3i position{};
+    uint32_t revision = 0;
+    // Revisions of the west, east, north and south chunks, 0 if not loaded
+    std::array<uint32_t, 4> neighbor_revisions{};
+    std::vector<Entrance> entrances{};
+    // Cost of walking from each entrance to the others inside the cluster, negative if unreachable
+    std::vector<int> costs{};
+  };
+
+  struct NodeReference
+  {
+    const Cluster* cluster = nullptr;
+    uint32_t entrance = 0;
+  };
+
+  std::shared_ptr<const WalkabilitySnapshot> m_snapshot = nullptr;
+  // Built graph to reuse clusters from, released once this graph is built
+  std::shared_ptr<const HierarchicalGraph> m_base = nullptr;
+  mutable std::mutex m_base_mutex{};
+  std::once_flag m_build_flag{};
+  std::atomic<bool> m_is_built = false;
+  std::unordered_map<uint64_t, std::shared_ptr<const Cluster>> m_clusters{};
+  // Maps packed entrance positions to their cluster
+  std::unordered_map<uint64_t, NodeReference> m_nodes{};
+
+  void m_build();
+  std::shared_ptr<const Cluster> m_create_cluster(const Vector3i& chunk_position,
+                                                  const std::array<uint32_t, 4>& neighbor_revisions) const;
+  const Cluster* m_get_cluster(const Vector3i& chunk_position) const;
+  std::vector<Vector3i> m_find_abstract_path(const Vector3i& from, const Vector3i& to) const;
+};
+}  // namespace dl
@@ -0,0 +1,220 @@
+#include "./pathfinding_service.hpp"
+
+#include <algorithm>
+
+#include "config.hpp"
+#include "world/a_star.hpp"
+#include "world/chunk_manager.hpp"
+#include "world/hierarchical_graph.hpp"
+#include "world/walkability_snapshot.hpp"
+#include "world/world.hpp"
+
+namespace
+{
+double elapsed_ms(const dl::PathfindingService::Clock::time_point& start,
+                  const dl::PathfindingService::Clock::time_point& end)
+{
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+}  // namespace
+
+namespace dl
+{
+PathfindingService::PathfindingService(World& world) : m_world(world)
+{
+  m_thread_count = std::max(config::pathfinding::worker_threads, uint32_t{1});
+  m_thread_pool.initialize(m_thread_count);
+}
+
+PathfindingService::~PathfindingService() { m_thread_pool.finalize(); }
+
+void PathfindingService::request(const entt::entity entity, const Vector3i& from, const Vector3i& to)
+{
+  const auto [it, inserted] = m_pending_entities.insert(entity);
+
+  if (!inserted)
+  {
+    return;
+  }
+
+  m_queued.push_back(Request{entity, from, to, Clock::now()});
+}
+
+bool PathfindingService::is_pending(const entt::entity entity) const { return m_pending_entities.contains(entity); }
+
+std::vector<PathfindingService::Result> PathfindingService::collect()
+{
+  std::vector<Result> results{};
+
+  {
+    std::scoped_lock lock(m_results_mutex);
+    results.swap(m_results);
+  }
+
+  for (const auto& result : results)
+  {
+    m_pending_entities.erase(result.entity);
+  }
+
+  return results;
+}
+
+void PathfindingService::dispatch()
+{
+  auto batch = std::make_shared<Batch>();
+
+  {
+    std::scoped_lock lock(m_results_mutex);
+
+    if (m_is_batch_running)
+    {
+      return;
+    }
+
+    // Requests that didn't fit in the previous budget go first
+    batch->requests.swap(m_carried_over);
+  }
+
+  batch->requests.insert(batch->requests.end(), m_queued.begin(), m_queued.end());
+  m_queued.clear();
+
+  if (batch->requests.empty())
+  {
+    return;
+  }
+
+  m_update_snapshot();
+
+  const auto budget = std::chrono::duration<double, std::milli>(config::pathfinding::turn_budget_ms);
+  const auto job_count = std::min(static_cast<std::size_t>(m_thread_count), batch->requests.size());
+
+  batch->snapshot = m_snapshot;
+  batch->graph = m_graph;
+  batch->solved.resize(batch->requests.size(), 0);
+  batch->deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(budget);
+  batch->remaining_jobs = job_count;
+
+  {
+    std::scoped_lock lock(m_results_mutex);
+    m_is_batch_running = true;
+    m_in_flight = batch->requests.size();
+  }
+
+  for (std::size_t i = 0; i < job_count; ++i)
+  {
+    m_thread_pool.queue_job([this, batch]() { m_solve_batch(*batch); });
+  }
+}
+
+PathfindingService::Stats PathfindingService::get_stats() const
+{
+  std::scoped_lock lock(m_results_mutex);
+
+  Stats stats{};
+  stats.queue_depth = m_queued.size() + m_carried_over.size() + m_in_flight;
+  stats.solved = m_solved;
+  stats.max_latency_ms = m_max_latency_ms;
+
+  if (m_solved > 0)
+  {
+    stats.average_latency_ms = m_total_latency_ms / m_solved;
+    stats.average_solve_ms = m_total_solve_ms / m_solved;
+  }
+
+  return stats;
+}
+
+void PathfindingService::m_update_snapshot()
+{
+  if (m_snapshot != nullptr && !m_snapshot->is_outdated(m_world))
+  {
+    return;
+  }
+
+  // Batches that are still running keep their own reference to the previous snapshot.
+  // The graph is only built by a worker once a long path is requested.
+  m_snapshot = std::make_shared<const WalkabilitySnapshot>(m_world, m_snapshot.get());
+  m_graph = std::make_shared<HierarchicalGraph>(m_snapshot, m_graph);
+}
+
+void PathfindingService::m_solve_batch(Batch& batch)
+{
+  const auto& snapshot = *batch.snapshot;
+
+  // Each worker keeps its search memory between batches, it's only allocated once per thread
+  thread_local AStar a_star{AStar::WalkableFunction{}};
+  a_star.set_walkable_function(
+      [&snapshot](const int x, const int y, const int z) { return snapshot.is_walkable(x, y, z); });
+
+  while (Clock::now() < batch.deadline)
+  {
+    const auto index = batch.next_request.fetch_add(1);
+
+    if (index >= batch.requests.size())
+    {
+      break;
+    }
+
+    const auto& request = batch.requests[index];
+    const auto solve_start = Clock::now();
+
+    Result result{request.entity, request.from, request.to};
+
+    // Long paths that cross chunk borders go through the abstract graph
+    if (ChunkManager::world_to_chunk(request.from) != ChunkManager::world_to_chunk(request.to))
+    {
+      batch.graph->build();
+      result.steps = batch.graph->find_path(request.from, request.to, a_star);
+    }
+    else
+    {
+      a_star.reset(request.from, request.to);
+
+      while (a_star.state == AStar::State::INITIALIZED || a_star.state == AStar::State::SEARCHING)
+      {
+        a_star.step();
+      }
+
+      if (a_star.state == AStar::State::SUCCEEDED)
+      {
+        result.steps = std::move(a_star.path);
+      }
+    }
+
+    const auto solve_end = Clock::now();
+    batch.solved[index] = 1;
+
+    {
+      std::scoped_lock lock(m_results_mutex);
+      const auto latency = elapsed_ms(request.requested_at, solve_end);
+
+      m_results.push_back(std::move(result));
+      --m_in_flight;
+      ++m_solved;
+      m_total_latency_ms += latency;
+      m_total_solve_ms += elapsed_ms(solve_start, solve_end);
+      m_max_latency_ms = std::max(m_max_latency_ms, latency);
+    }
+  }
+
+  // The snapshot may be released once the batch is done
+  a_star.set_walkable_function(nullptr);
+
+  // The last worker to finish hands the unsolved requests over to the next turn
+  if (batch.remaining_jobs.fetch_sub(1) == 1)
+  {
+    std::scoped_lock lock(m_results_mutex);
+
+    for (std::size_t i = 0; i < batch.requests.size(); ++i)
+    {
+      if (!batch.solved[i])
+      {
+        m_carried_over.push_back(batch.requests[i]);
+      }
+    }
+
+    m_in_flight = 0;
+    m_is_batch_running = false;
+  }
+}
+}  // namespace dl
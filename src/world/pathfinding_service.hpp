@@ -0,0 +1,113 @@
+#pragma once
+
+#include <entt/entity/entity.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "core/maths/vector.hpp"
+#include "core/thread_pool.hpp"
+
+namespace dl
+{
+class World;
+class WalkabilitySnapshot;
+class HierarchicalGraph;
+
+// Solves path requests in the background against a snapshot of the world
+// walkability. Requests are collected during a turn and dispatched as a single
+// batch, each worker solves requests until the turn budget runs out and the
+// remaining ones are carried over to the next turn. Paths between different
+// chunks are searched on a HierarchicalGraph and refined with AStar.
+class PathfindingService
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Result
+  {
+    entt::entity entity = entt::null;
+    Vector3i from{};
+    Vector3i to{};
+    std::vector<Vector3i> steps{};
+  };
+
+  struct Stats
+  {
+    // Requests waiting to be dispatched or being solved
+    std::size_t queue_depth = 0;
+    std::size_t solved = 0;
+    // Time from the request to the result being available
+    double average_latency_ms = 0.0;
+    double max_latency_ms = 0.0;
+    // Time spent in A* for a single request
+    double average_solve_ms = 0.0;
+  };
+
+  PathfindingService(World& world);
+  ~PathfindingService();
+
+  PathfindingService(const PathfindingService&) = delete;
+  PathfindingService& operator=(const PathfindingService&) = delete;
+
+  // Queues a path request, ignored if the entity already has one pending
+  void request(const entt::entity entity, const Vector3i& from, const Vector3i& to);
+  bool is_pending(const entt::entity entity) const;
+
+  // Returns the results finished since the last call
+  std::vector<Result> collect();
+
+  // Sends the queued requests to the workers if the previous batch is done
+  void dispatch();
+
+  Stats get_stats() const;
+
+ private:
+  struct Request
+  {
+    entt::entity entity = entt::null;
+    Vector3i from{};
+    Vector3i to{};
+    Clock::time_point requested_at{};
+  };
+
+  struct Batch
+  {
+    std::shared_ptr<const WalkabilitySnapshot> snapshot = nullptr;
+    std::shared_ptr<HierarchicalGraph> graph = nullptr;
+    std::vector<Request> requests{};
+    std::vector<uint8_t> solved{};
+    Clock::time_point deadline{};
+    std::atomic<std::size_t> next_request = 0;
+    std::atomic<uint32_t> remaining_jobs = 0;
+  };
+
+  World& m_world;
+  ThreadPool m_thread_pool{};
+  uint32_t m_thread_count = 0;
+  std::shared_ptr<const WalkabilitySnapshot> m_snapshot = nullptr;
+  std::shared_ptr<HierarchicalGraph> m_graph = nullptr;
+
+  // Main thread only
+  std::vector<Request> m_queued{};
+  std::unordered_set<entt::entity> m_pending_entities{};
+
+  // Shared with the workers
+  mutable std::mutex m_results_mutex{};
+  std::vector<Result> m_results{};
+  std::vector<Request> m_carried_over{};
+  bool m_is_batch_running = false;
+  std::size_t m_in_flight = 0;
+  std::size_t m_solved = 0;
+  double m_total_latency_ms = 0.0;
+  double m_max_latency_ms = 0.0;
+  double m_total_solve_ms = 0.0;
+
+  void m_update_snapshot();
+  void m_solve_batch(Batch& batch);
+};
+}  // namespace dl
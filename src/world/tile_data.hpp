@@ -5,6 +5,7 @@
 #include <unordered_set>
 
 #include "./society/job_type.hpp"
+#include "./tile_flag.hpp"
 
 namespace dl
 {
@@ -33,7 +34,11 @@ struct TileData
   uint32_t id;
   std::string name;
   std::unordered_set<std::string> flags;
+  // Known flags compiled to a TileFlag bitmask
+  uint32_t flag_bits = DL_TILE_FLAG_NONE;
   std::unordered_map<JobType, Action> actions{};
   Direction climbs_to;
+
+  bool has_flags(const uint32_t flags) const { return (flag_bits & flags) == flags; }
 };
 }  // namespace dl
@@ -1,6 +1,55 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
+namespace dl
+{
+// Bitmask version of the tile flags, compiled when the tile data is loaded so
+// that hot paths don't need to look up strings
+enum TileFlag : uint32_t
+{
+  DL_TILE_FLAG_NONE = 0,
+  DL_TILE_FLAG_WALKABLE = 1,
+  DL_TILE_FLAG_HARVESTABLE = 2,
+  DL_TILE_FLAG_SLOPE = 4,
+  DL_TILE_FLAG_FIRE = 8,
+  DL_TILE_FLAG_HURTS = 16,
+};
+}  // namespace dl
+
 namespace dl::tile_flag
 {
 static const auto walkable = "WALKABLE";
+static const auto harvestable = "HARVESTABLE";
+static const auto slope = "SLOPE";
+static const auto fire = "FIRE";
+static const auto hurts = "HURTS";
+
+// Gets the bit of a flag name, DL_TILE_FLAG_NONE if the flag doesn't have one
+inline TileFlag to_bit(const std::string& flag)
+{
+  if (flag == walkable)
+  {
+    return DL_TILE_FLAG_WALKABLE;
+  }
+  if (flag == harvestable)
+  {
+    return DL_TILE_FLAG_HARVESTABLE;
+  }
+  if (flag == slope)
+  {
+    return DL_TILE_FLAG_SLOPE;
+  }
+  if (flag == fire)
+  {
+    return DL_TILE_FLAG_FIRE;
+  }
+  if (flag == hurts)
+  {
+    return DL_TILE_FLAG_HURTS;
+  }
+
+  return DL_TILE_FLAG_NONE;
+}
 }  // namespace dl::tile_flag
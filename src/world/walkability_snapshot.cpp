@@ -0,0 +1,103 @@
+#include "./walkability_snapshot.hpp"
+
+#include "world/chunk_manager.hpp"
+#include "world/world.hpp"
+
+namespace
+{
+std::shared_ptr<const dl::WalkabilitySnapshot::ChunkWalkability> create_chunk_walkability(const dl::Chunk& chunk)
+{
+  auto walkability = std::make_shared<dl::WalkabilitySnapshot::ChunkWalkability>();
+  walkability->position = chunk.position;
+  walkability->size = chunk.tiles.size;
+  walkability->revision = chunk.revision;
+  walkability->bits = chunk.walkable_cells;
+
+  return walkability;
+}
+}  // namespace
+
+namespace dl
+{
+bool WalkabilitySnapshot::ChunkWalkability::is_walkable(const int x, const int y, const int z) const
+{
+  if (x < 0 || y < 0 || z < 0 || x >= size.x || y >= size.y || z >= size.z || bits.empty())
+  {
+    return false;
+  }
+
+  // Same layout as Grid3D values
+  const std::size_t index = x + y * size.x + z * size.x * size.y;
+  return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+WalkabilitySnapshot::WalkabilitySnapshot(const World& world, const WalkabilitySnapshot* previous)
+{
+  m_chunks.reserve(world.chunk_manager.chunks.size());
+
+  for (const auto& chunk : world.chunk_manager.chunks)
+  {
+    const auto key = ChunkManager::chunk_key(chunk->position);
+
+    if (previous != nullptr)
+    {
+      const auto it = previous->m_chunks.find(key);
+
+      if (it != previous->m_chunks.end() && it->second->revision == chunk->revision)
+      {
+        m_chunks.emplace(key, it->second);
+        continue;
+      }
+    }
+
+    m_chunks.emplace(key, create_chunk_walkability(*chunk));
+  }
+}
+
+bool WalkabilitySnapshot::is_walkable(const int x, const int y, const int z) const
+{
+  const auto chunk_position = ChunkManager::world_to_chunk(x, y, z);
+  const auto it = m_chunks.find(ChunkManager::chunk_key(chunk_position));
+
+  if (it == m_chunks.end())
+  {
+    return false;
+  }
+
+  return it->second->is_walkable(x - chunk_position.x, y - chunk_position.y, z - chunk_position.z);
+}
+
+const WalkabilitySnapshot::ChunkWalkability* WalkabilitySnapshot::get_chunk(const Vector3i& chunk_position) const
+{
+  const auto it = m_chunks.find(ChunkManager::chunk_key(chunk_position));
+
+  if (it == m_chunks.end())
+  {
+    return nullptr;
+  }
+
+  return it->second.get();
+}
+
+bool WalkabilitySnapshot::is_outdated(const World& world) const
+{
+  const auto& chunks = world.chunk_manager.chunks;
+
+  if (chunks.size() != m_chunks.size())
+  {
+    return true;
+  }
+
+  for (const auto& chunk : chunks)
+  {
+    const auto it = m_chunks.find(ChunkManager::chunk_key(chunk->position));
+
+    if (it == m_chunks.end() || it->second->revision != chunk->revision)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+}  // namespace dl
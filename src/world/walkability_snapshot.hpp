@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "core/maths/vector.hpp"
+
+namespace dl
+{
+class World;
+
+// Immutable copy of the walkability of the loaded chunks. It's built on the
+// main thread and can then be queried from any thread while the world keeps
+// changing, e.g. to solve paths in the background.
+class WalkabilitySnapshot
+{
+ public:
+  struct ChunkWalkability
+  {
+    Vector3i position{};
+    Vector3i size{};
+    uint32_t revision = 0;
+    // One bit per cell, set if the cell is walkable
+    std::vector<uint64_t> bits{};
+
+    // Queries a position relative to the chunk origin
+    bool is_walkable(const int x, const int y, const int z) const;
+  };
+
+  // Builds a snapshot of the loaded chunks, reusing the data of chunks that
+  // didn't change since the previous snapshot
+  WalkabilitySnapshot(const World& world, const WalkabilitySnapshot* previous = nullptr);
+
+  bool is_walkable(const int x, const int y, const int z) const;
+
+  // Returns nullptr if the chunk wasn't loaded when the snapshot was taken
+  const ChunkWalkability* get_chunk(const Vector3i& chunk_position) const;
+  const std::unordered_map<uint64_t, std::shared_ptr<const ChunkWalkability>>& get_chunks() const { return m_chunks; }
+
+  // Checks if any chunk was loaded, unloaded or modified after the snapshot was taken
+  bool is_outdated(const World& world) const;
+
+ private:
+  std::unordered_map<uint64_t, std::shared_ptr<const ChunkWalkability>> m_chunks{};
+};
+}  // namespace dl
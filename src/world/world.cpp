@@ -4,13 +4,13 @@
 
 #include <entt/core/hashed_string.hpp>
 #include <entt/entity/registry.hpp>
+#include <array>
 #include <fstream>
 #include <libtcod.hpp>
 #include <nlohmann/json.hpp>
 #include <queue>
 #include <set>
 
-#include "./a_star.hpp"
 #include "./cell.hpp"
 #include "./generators/tile_rules.hpp"
 #include "./item_factory.hpp"
@@ -65,24 +65,64 @@ void World::generate_societies()
 void World::set_top_face(const uint32_t tile_id, const int x, const int y, const int z)
 {
   auto& chunk = chunk_manager.at(x, y, z);
-  chunk.tiles.set(
-      tile_id, std::abs(x - chunk.position.x), std::abs(y - chunk.position.y), std::abs(z - chunk.position.z));
-
-  if (!chunk.tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, x, y, z))
-  {
-    chunk.tiles.compute_visibility();
-  }
+  const Vector3i local{std::abs(x - chunk.position.x), std::abs(y - chunk.position.y), std::abs(z - chunk.position.z)};
+  chunk.tiles.set(tile_id, local);
+  chunk.update_walkability(tile_flags, local.x, local.y, local.z);
+  chunk.mark_modified();
+  m_update_visibility(x, y, z);
 }
 
 void World::set_top_face_decoration(const uint32_t tile_id, const int x, const int y, const int z)
 {
   auto& chunk = chunk_manager.at(x, y, z);
-  chunk.tiles.set_top_face_decoration(
-      tile_id, std::abs(x - chunk.position.x), std::abs(y - chunk.position.y), std::abs(z - chunk.position.z));
+  const Vector3i local{std::abs(x - chunk.position.x), std::abs(y - chunk.position.y), std::abs(z - chunk.position.z)};
+  chunk.tiles.set_top_face_decoration(tile_id, local);
+  chunk.update_walkability(tile_flags, local.x, local.y, local.z);
+  chunk.mark_modified();
+  m_update_visibility(x, y, z);
+}
+
+void World::m_update_visibility(const int x, const int y, const int z)
+{
+  const auto block_type_at = [this](const Vector3i& position) {
+    const auto& chunk = chunk_manager.at(position);
+
+    if (&chunk == &ChunkManager::null)
+    {
+      return BlockType::None;
+    }
 
-  if (!chunk.tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, x, y, z))
+    return chunk.tiles.block_type_at(position - chunk.position);
+  };
+
+  // A block can only hide the top face of the cell below it and the front face of the cell
+  // behind it, any of them can be in a neighbour chunk
+  const std::array<Vector3i, 3> positions{Vector3i{x, y, z}, Vector3i{x, y, z - 1}, Vector3i{x, y - 1, z}};
+  const auto& edited_chunk = chunk_manager.at(x, y, z);
+
+  for (const auto& position : positions)
   {
-    chunk.tiles.compute_visibility();
+    auto& chunk = chunk_manager.at(position);
+
+    if (&chunk == &ChunkManager::null)
+    {
+      continue;
+    }
+
+    const auto local = position - chunk.position;
+    const auto top_block_type = block_type_at(position + Vector3i{0, 0, 1});
+    const auto front_block_type = block_type_at(position + Vector3i{0, 1, 0});
+
+    const bool has_changed
+        = chunk.tiles.update_cell_visibility(local.x, local.y, local.z, top_block_type, front_block_type);
+    chunk.tiles.update_height(local.x, local.y);
+
+    // The edited chunk is already marked, a neighbour is only marked when its faces changed
+    // so that its mesh, save and clusters aren't rebuilt for nothing
+    if (has_changed && &chunk != &edited_chunk)
+    {
+      chunk.mark_modified();
+    }
   }
 }
 
@@ -220,14 +260,22 @@ Vector3i World::screen_to_world(const Vector2i& position, const Camera& camera)
   auto world_position = Vector3i{std::floor((position.x + camera_position.x) / static_cast<double>(grid_size.x)),
                                  std::floor((position.y + camera_position.y) / static_cast<double>(grid_size.y)),
                                  0.0};
+
+  // The highest cell along the view ray with a visible top face is the one drawn at this position
   for (int z = world::chunk_size.z - 1; z >= 0; --z)
   {
-    const int queried_elevation = get_elevation(world_position.x, world_position.y + z);
+    const int y = world_position.y + z;
+    const auto& chunk = chunk_manager.at(world_position.x, y, 0);
 
-    if (queried_elevation == z)
+    if (&chunk == &ChunkManager::null)
     {
-      world_position.z = queried_elevation;
-      world_position.y += queried_elevation;
+      continue;
+    }
+
+    if (chunk.tiles.is_top_face_visible(world_position.x - chunk.position.x, y - chunk.position.y, z))
+    {
+      world_position.z = z;
+      world_position.y = y;
       break;
     }
   }
@@ -249,18 +297,18 @@ std::vector<Vector3i> World::find_path(const Vector3i& from, const Vector3i& to)
     return {to};
   }
 
-  AStar a_star(*this, from, to);
+  m_a_star.reset(from, to);
 
   do
   {
-    a_star.step();
-  } while (a_star.state == AStar::State::SEARCHING);
+    m_a_star.step();
+  } while (m_a_star.state == AStar::State::SEARCHING);
 
-  // a_star.debug(*m_game_context.registry, false, true);
+  // m_a_star.debug(*m_game_context.registry, false, true);
 
-  if (a_star.state == AStar::State::SUCCEEDED)
+  if (m_a_star.state == AStar::State::SUCCEEDED)
   {
-    return a_star.path;
+    return m_a_star.path;
   }
 
   return {};
@@ -322,7 +370,7 @@ TileTarget World::search_by_flag(const std::string& flag, const Vector3i& start)
           break;
         }
 
-        if (tile.flags.contains(tile_flag::walkable))
+        if (is_walkable(current.x, current.y, current.z))
         {
           position_queue.push(current);
         }
@@ -367,8 +415,8 @@ bool World::is_walkable(const int x, const int y, const int z) const
 {
   using namespace entt::literals;
 
-  const auto& tile = get(x, y, z);
-  bool walkable = tile.flags.contains(tile_flag::walkable);
+  const auto& chunk = chunk_manager.at(x, y, z);
+  bool walkable = chunk.is_walkable(x - chunk.position.x, y - chunk.position.y, z - chunk.position.z);
 
   // if (walkable)
   // {
@@ -383,6 +431,11 @@ bool World::is_walkable(const int x, const int y, const int z) const
   return walkable;
 }
 
+bool World::has_tile_flags(const uint32_t tile_id, const uint32_t flags) const
+{
+  return tile_id < tile_flags.size() && (tile_flags[tile_id] & flags) == flags;
+}
+
 bool World::is_empty(const int x, const int y, const int z) const
 {
   const auto& cell = cell_at(x, y, z);
@@ -455,6 +508,11 @@ void World::m_load_tile_data()
     json::assign_if_contains<std::unordered_set<std::string>>(tile, "flags", tile_data.flags);
     json::assign_if_contains<Direction>(tile, "climbs_to", tile_data.climbs_to);
 
+    for (const auto& flag : tile_data.flags)
+    {
+      tile_data.flag_bits |= tile_flag::to_bit(flag);
+    }
+
     if (tile.contains("actions"))
     {
       const auto actions_data = tile["actions"].get<std::vector<nlohmann::json>>();
@@ -470,8 +528,16 @@ void World::m_load_tile_data()
       }
     }
 
+    if (tile_data.id >= tile_flags.size())
+    {
+      tile_flags.resize(tile_data.id + 1, DL_TILE_FLAG_NONE);
+    }
+
+    tile_flags[tile_data.id] = tile_data.flag_bits;
     this->tile_data[tile_data.id] = tile_data;
   }
+
+  chunk_manager.set_tile_flags(tile_flags);
 }
 
 std::unordered_map<uint32_t, Action> World::m_load_actions()
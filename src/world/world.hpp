@@ -5,6 +5,7 @@
 #include <stack>
 #include <vector>
 
+#include "./a_star.hpp"
 #include "./chunk_manager.hpp"
 #include "./grid_3d.hpp"
 #include "./item_data.hpp"
@@ -57,6 +58,8 @@ class World
   SpatialHash spatial_hash;
   ChunkManager chunk_manager{m_game_context};
   std::unordered_map<uint32_t, TileData> tile_data;
+  // TileFlag bitmask of each tile indexed by tile id
+  std::vector<uint32_t> tile_flags;
   std::unordered_map<uint32_t, ItemData> item_data;
   bool has_initialized = false;
 
@@ -142,6 +145,9 @@ class World
   // Check if a specific tile is has WALKABLE flag
   [[nodiscard]] bool is_walkable(const int x, const int y, const int z) const;
 
+  // Check if a tile id has all the TileFlag bits in flags
+  [[nodiscard]] bool has_tile_flags(const uint32_t tile_id, const uint32_t flags) const;
+
   // Check if a specific tile is empty
   [[nodiscard]] bool is_empty(const int x, const int y, const int z) const;
 
@@ -171,6 +177,12 @@ class World
   Vector2i m_tile_size{0, 0};
   std::map<uint32_t, SocietyBlueprint> m_societies;
 
+  // Pathfinder reused between searches to avoid reallocating its node pools
+  AStar m_a_star{*this};
+
+  // Updates visibility flags and heights around a cell that was edited
+  void m_update_visibility(const int x, const int y, const int z);
+
   // Load information about tiles
   void m_load_tile_data();
   std::unordered_map<uint32_t, Action> m_load_actions();
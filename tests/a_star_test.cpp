@@ -0,0 +1,361 @@
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./test.hpp"
+#include "world/a_star.hpp"
+
+using namespace dl;
+
+namespace
+{
+constexpr int unreachable = std::numeric_limits<int>::max();
+
+// Small flat map where '.' is walkable at z = 0 and '#' is blocked, cells marked with '^' are
+// a raised platform that can only be walked on at z = 1
+struct Grid
+{
+  std::vector<std::string> rows{};
+
+  int width() const { return static_cast<int>(rows.front().size()); }
+  int height() const { return static_cast<int>(rows.size()); }
+
+  bool is_walkable(const int x, const int y, const int z) const
+  {
+    if (x < 0 || y < 0 || x >= width() || y >= height())
+    {
+      return false;
+    }
+
+    const char cell = rows[y][x];
+    return (cell == '.' && z == 0) || (cell == '^' && z == 1);
+  }
+
+  AStar::WalkableFunction walkable_function() const
+  {
+    return [this](const int x, const int y, const int z) { return is_walkable(x, y, z); };
+  }
+};
+
+// Dijkstra over the same 8 connected moves and costs on the z = 0 level, without climbing
+int get_optimal_cost(const Grid& grid, const Vector3i& origin, const Vector3i& destination)
+{
+  using QueueItem = std::pair<int, int>;
+
+  std::vector<int> costs(grid.width() * grid.height(), unreachable);
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue{};
+
+  costs[origin.x + origin.y * grid.width()] = 0;
+  queue.push({0, origin.x + origin.y * grid.width()});
+
+  while (!queue.empty())
+  {
+    const auto [cost, index] = queue.top();
+    queue.pop();
+
+    if (cost > costs[index])
+    {
+      continue;
+    }
+
+    const Vector3i current{index % grid.width(), index / grid.width(), 0};
+
+    if (current == destination)
+    {
+      return cost;
+    }
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        const Vector3i neighbor{current.x + dx, current.y + dy, 0};
+
+        if ((dx == 0 && dy == 0) || !grid.is_walkable(neighbor.x, neighbor.y, neighbor.z))
+        {
+          continue;
+        }
+
+        const int neighbor_cost = cost + AStar::get_cost(current, neighbor, dx != 0 && dy != 0);
+        const int neighbor_index = neighbor.x + neighbor.y * grid.width();
+
+        if (neighbor_cost < costs[neighbor_index])
+        {
+          costs[neighbor_index] = neighbor_cost;
+          queue.push({neighbor_cost, neighbor_index});
+        }
+      }
+    }
+  }
+
+  return unreachable;
+}
+
+void search(AStar& a_star, const Vector3i& origin, const Vector3i& destination, const std::size_t max_steps = 0)
+{
+  a_star.reset(origin, destination, max_steps);
+
+  while (a_star.state == AStar::State::INITIALIZED || a_star.state == AStar::State::SEARCHING)
+  {
+    a_star.step();
+  }
+}
+
+// Checks that the path goes from the destination to the origin through adjacent walkable positions
+bool is_valid_path(const Grid& grid, const AStar& a_star)
+{
+  const auto& path = a_star.path;
+
+  if (path.empty() || path.front() != a_star.destination || path.back() != a_star.origin)
+  {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < path.size(); ++i)
+  {
+    if (!grid.is_walkable(path[i].x, path[i].y, path[i].z))
+    {
+      return false;
+    }
+    if (i == 0)
+    {
+      continue;
+    }
+
+    const auto delta = path[i] - path[i - 1];
+
+    if (std::abs(delta.x) > 1 || std::abs(delta.y) > 1 || std::abs(delta.z) > 1 || (delta.x == 0 && delta.y == 0))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int get_path_cost(const std::vector<Vector3i>& path)
+{
+  int cost = 0;
+
+  // The path is stored from the destination to the origin
+  for (std::size_t i = path.size() - 1; i > 0; --i)
+  {
+    const bool is_diagonal = path[i].x != path[i - 1].x && path[i].y != path[i - 1].y;
+    cost += AStar::get_cost(path[i], path[i - 1], is_diagonal);
+  }
+
+  return cost;
+}
+
+// Deterministic maps with about a quarter of the cells blocked
+Grid create_random_grid(const int width, const int height, uint32_t seed)
+{
+  Grid grid{};
+
+  for (int y = 0; y < height; ++y)
+  {
+    std::string row{};
+
+    for (int x = 0; x < width; ++x)
+    {
+      seed = seed * 1664525u + 1013904223u;
+      row.push_back((seed >> 24) % 4 == 0 ? '#' : '.');
+    }
+
+    grid.rows.push_back(std::move(row));
+  }
+
+  return grid;
+}
+}  // namespace
+
+DL_TEST(a_star_finds_optimal_path_on_open_grid)
+{
+  const Grid grid{{
+      "............",
+      "............",
+      "............",
+      "............",
+      "............",
+      "............",
+  }};
+  AStar a_star{grid.walkable_function()};
+
+  for (const auto& destination : {Vector3i{11, 5, 0}, Vector3i{11, 0, 0}, Vector3i{0, 5, 0}, Vector3i{7, 2, 0}})
+  {
+    search(a_star, Vector3i{0, 0, 0}, destination);
+
+    DL_CHECK(a_star.state == AStar::State::SUCCEEDED);
+    DL_CHECK(is_valid_path(grid, a_star));
+    DL_CHECK(get_path_cost(a_star.path) == get_optimal_cost(grid, Vector3i{0, 0, 0}, destination));
+  }
+}
+
+DL_TEST(a_star_path_cost_is_bounded_by_reference_search)
+{
+  const Grid grid{{
+      "..........#.........",
+      ".########.#.######..",
+      ".#......#.#......#..",
+      ".#.####.#.######.#..",
+      ".#.#....#........#..",
+      ".#.#.#########.###..",
+      "...#.............#..",
+      "####.###########.#..",
+      "...................#",
+      ".#################..",
+  }};
+  const Vector3i origin{0, 0, 0};
+  const Vector3i destination{5, 4, 0};
+  AStar a_star{grid.walkable_function()};
+
+  search(a_star, origin, destination);
+
+  const int optimal_cost = get_optimal_cost(grid, origin, destination);
+  const int cost = get_path_cost(a_star.path);
+
+  DL_CHECK(a_star.state == AStar::State::SUCCEEDED);
+  DL_CHECK(is_valid_path(grid, a_star));
+  // The heuristic is weighted by 1.2, so the path can be at most 20% longer than the shortest one
+  DL_CHECK(cost >= optimal_cost);
+  DL_CHECK(cost * 5 <= optimal_cost * 6);
+}
+
+DL_TEST(a_star_matches_reference_search_on_random_grids)
+{
+  constexpr int width = 24;
+  constexpr int height = 16;
+
+  for (uint32_t seed = 1; seed <= 40; ++seed)
+  {
+    const auto grid = create_random_grid(width, height, seed);
+    AStar a_star{grid.walkable_function()};
+
+    for (const auto& [origin, destination] : {std::pair{Vector3i{0, 0, 0}, Vector3i{width - 1, height - 1, 0}},
+                                               std::pair{Vector3i{width - 1, 0, 0}, Vector3i{0, height - 1, 0}},
+                                               std::pair{Vector3i{3, 8, 0}, Vector3i{20, 7, 0}}})
+    {
+      if (!grid.is_walkable(origin.x, origin.y, origin.z))
+      {
+        continue;
+      }
+
+      search(a_star, origin, destination, width * height);
+
+      const int optimal_cost = get_optimal_cost(grid, origin, destination);
+
+      if (optimal_cost == unreachable)
+      {
+        DL_CHECK(a_star.state == AStar::State::FAILED);
+        DL_CHECK(a_star.path.empty());
+        continue;
+      }
+
+      const int cost = get_path_cost(a_star.path);
+
+      DL_CHECK(a_star.state == AStar::State::SUCCEEDED);
+      DL_CHECK(is_valid_path(grid, a_star));
+      DL_CHECK(cost >= optimal_cost);
+      DL_CHECK(cost * 5 <= optimal_cost * 6);
+    }
+  }
+}
+
+DL_TEST(a_star_fails_on_blocked_destination)
+{
+  const Grid grid{{
+      "......",
+      "...#..",
+      "......",
+  }};
+  AStar a_star{grid.walkable_function()};
+
+  search(a_star, Vector3i{0, 0, 0}, Vector3i{3, 1, 0});
+
+  // The search doesn't start if the destination can't be walked on
+  DL_CHECK(a_star.state == AStar::State::FAILED);
+  DL_CHECK(a_star.steps == 0);
+  DL_CHECK(a_star.path.empty());
+}
+
+DL_TEST(a_star_fails_on_unreachable_destination)
+{
+  const Grid grid{{
+      "........",
+      "....###.",
+      "....#.#.",
+      "....###.",
+      "........",
+  }};
+  AStar a_star{grid.walkable_function()};
+
+  search(a_star, Vector3i{0, 0, 0}, Vector3i{5, 2, 0});
+
+  DL_CHECK(get_optimal_cost(grid, Vector3i{0, 0, 0}, Vector3i{5, 2, 0}) == unreachable);
+  DL_CHECK(a_star.state == AStar::State::FAILED);
+  DL_CHECK(a_star.path.empty());
+  // Each of the 31 cells outside of the walls is expanded once before giving up
+  DL_CHECK(a_star.steps == 31);
+}
+
+DL_TEST(a_star_stops_at_max_steps)
+{
+  const Grid grid{{
+      "..............................",
+      "#############################.",
+      "..............................",
+  }};
+  const Vector3i origin{0, 0, 0};
+  const Vector3i destination{0, 2, 0};
+  AStar a_star{grid.walkable_function()};
+
+  search(a_star, origin, destination, 20);
+
+  DL_CHECK(a_star.state == AStar::State::FAILED);
+  DL_CHECK(a_star.steps == 21);
+  DL_CHECK(a_star.path.empty());
+
+  search(a_star, origin, destination, 200);
+
+  DL_CHECK(a_star.state == AStar::State::SUCCEEDED);
+  DL_CHECK(is_valid_path(grid, a_star));
+  DL_CHECK(get_path_cost(a_star.path) == get_optimal_cost(grid, origin, destination));
+}
+
+DL_TEST(a_star_returns_empty_path_to_origin)
+{
+  const Grid grid{{"..."}};
+  AStar a_star{grid.walkable_function()};
+
+  search(a_star, Vector3i{1, 0, 0}, Vector3i{1, 0, 0});
+
+  DL_CHECK(a_star.state == AStar::State::SUCCEEDED);
+  DL_CHECK(a_star.path.empty());
+}
+
+DL_TEST(a_star_climbs_to_raised_platform)
+{
+  const Grid grid{{
+      "........",
+      "....^^^.",
+      "....^^^.",
+      "........",
+  }};
+  const Vector3i origin{0, 1, 0};
+  const Vector3i destination{5, 1, 1};
+  AStar a_star{grid.walkable_function()};
+
+  search(a_star, origin, destination);
+
+  DL_CHECK(a_star.state == AStar::State::SUCCEEDED);
+  DL_CHECK(is_valid_path(grid, a_star));
+  DL_CHECK(a_star.path[1].z == 1);
+
+  // Three flat steps, a climb that costs three times a flat step and a last flat step on the platform
+  DL_CHECK(get_path_cost(a_star.path) == 3 * 100 + 3 * 100 + 100);
+}
@@ -0,0 +1,161 @@
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "./test.hpp"
+#include "config.hpp"
+#include "constants.hpp"
+#include "core/game_context.hpp"
+#include "core/timer.hpp"
+#include "world/chunk.hpp"
+#include "world/chunk_manager.hpp"
+
+using namespace dl;
+
+namespace
+{
+// The lookups don't read the tiles, small chunks keep the generation fast. Chunks outside of
+// the island map are generated as sea, so they don't need an island either.
+const Vector3i small_chunk_size{8, 8, 4};
+constexpr int lookup_count = 1'000'000;
+
+Vector3i get_chunk_position(const int i, const int j)
+{
+  return Vector3i{i * world::chunk_size.x, j * world::chunk_size.y, 0};
+}
+
+void generate_region(ChunkManager& chunk_manager, const int region_size)
+{
+  for (int j = 0; j < region_size; ++j)
+  {
+    for (int i = 0; i < region_size; ++i)
+    {
+      chunk_manager.generate_sync(get_chunk_position(i, j), small_chunk_size);
+    }
+  }
+}
+
+const Chunk* find_loaded_chunk(const ChunkManager& chunk_manager, const Vector3i& chunk_position)
+{
+  for (const auto& chunk : chunk_manager.chunks)
+  {
+    if (chunk->position == chunk_position)
+    {
+      return chunk.get();
+    }
+  }
+
+  return nullptr;
+}
+
+// Average time of ChunkManager::at in nanoseconds, looking up random tiles of a square region of chunks
+double get_lookup_time(const int region_size)
+{
+  GameContext game_context{};
+  ChunkManager chunk_manager{game_context};
+  chunk_manager.mode = ChunkManager::Mode::NoLoadingOrSaving;
+
+  generate_region(chunk_manager, region_size);
+
+  std::vector<Vector3i> positions{};
+  positions.reserve(lookup_count);
+  uint32_t random_state = 7;
+
+  for (int i = 0; i < lookup_count; ++i)
+  {
+    random_state = random_state * 1664525u + 1013904223u;
+    const int x = (random_state >> 8) % (region_size * world::chunk_size.x);
+    random_state = random_state * 1664525u + 1013904223u;
+    const int y = (random_state >> 8) % (region_size * world::chunk_size.y);
+    positions.push_back(Vector3i{x, y, 0});
+  }
+
+  int missing_count = 0;
+  Timer timer{};
+  timer.start();
+
+  for (const auto& position : positions)
+  {
+    missing_count += &chunk_manager.at(position) == &ChunkManager::null ? 1 : 0;
+  }
+
+  timer.stop();
+
+  DL_CHECK(missing_count == 0);
+
+  return timer.count<std::chrono::nanoseconds>() / static_cast<double>(lookup_count);
+}
+}  // namespace
+
+DL_TEST(chunk_manager_lookup_benchmark)
+{
+  config::load();
+
+  for (const int region_size : {3, 10, 20})
+  {
+    spdlog::info("ChunkManager::at with {} chunks: {:.1f} ns", region_size * region_size, get_lookup_time(region_size));
+  }
+}
+
+DL_TEST(chunk_manager_lookup_after_unload_and_reload)
+{
+  config::load();
+
+  GameContext game_context{};
+  ChunkManager chunk_manager{game_context};
+  chunk_manager.mode = ChunkManager::Mode::NoLoadingOrSaving;
+  chunk_manager.set_frustum(Vector2i{world::chunk_size.x, world::chunk_size.y});
+
+  const Vector3i near_target{world::chunk_size.x, world::chunk_size.y, 0};
+  const Vector3i far_target{near_target.x + 64 * world::chunk_size.x, near_target.y, 0};
+  const auto chunk_position = get_chunk_position(1, 1);
+
+  generate_region(chunk_manager, 3);
+  chunk_manager.update(near_target);
+
+  // Fills the last chunk cache of this thread
+  const auto& chunk = chunk_manager.at(chunk_position);
+  const auto revision = chunk.revision;
+
+  DL_CHECK(&chunk == find_loaded_chunk(chunk_manager, chunk_position));
+
+  // Moving away unloads the chunks, the cached chunk must not be returned anymore
+  chunk_manager.update(far_target);
+
+  DL_CHECK(find_loaded_chunk(chunk_manager, chunk_position) == nullptr);
+  DL_CHECK(&chunk_manager.at(chunk_position) == &ChunkManager::null);
+
+  // Coming back loads a new chunk at the same position, the lookup finds the new one
+  chunk_manager.update(near_target);
+  chunk_manager.generate_sync(chunk_position, small_chunk_size);
+
+  const auto* reloaded_chunk = find_loaded_chunk(chunk_manager, chunk_position);
+
+  DL_CHECK(reloaded_chunk != nullptr);
+  DL_CHECK(&chunk_manager.at(chunk_position) == reloaded_chunk);
+  DL_CHECK(chunk_manager.at(chunk_position).revision != revision);
+  DL_CHECK(&chunk_manager.at(chunk_position + Vector3i{5, 5, 0}) == reloaded_chunk);
+}
+
+DL_TEST(chunk_manager_lookup_after_replacing_chunk)
+{
+  config::load();
+
+  GameContext game_context{};
+  ChunkManager chunk_manager{game_context};
+  chunk_manager.mode = ChunkManager::Mode::NoLoadingOrSaving;
+
+  const auto chunk_position = get_chunk_position(2, 3);
+
+  chunk_manager.generate_sync(chunk_position, small_chunk_size);
+  const auto revision = chunk_manager.at(chunk_position).revision;
+
+  // A chunk loaded twice replaces the previous one
+  chunk_manager.generate_sync(chunk_position, small_chunk_size);
+
+  DL_CHECK(chunk_manager.chunks.size() == 1);
+  DL_CHECK(&chunk_manager.at(chunk_position) == chunk_manager.chunks.front().get());
+  DL_CHECK(chunk_manager.at(chunk_position).revision != revision);
+}
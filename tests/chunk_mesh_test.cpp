@@ -0,0 +1,281 @@
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "./test.hpp"
+#include "ecs/components/tile.hpp"
+#include "graphics/chunk_mesh.hpp"
+#include "graphics/chunk_mesher.hpp"
+#include "graphics/frame_data_types.hpp"
+#include "graphics/renderer/batch.hpp"
+#include "graphics/renderer/spritesheet.hpp"
+#include "world/chunk.hpp"
+
+using namespace dl;
+
+namespace
+{
+constexpr uint32_t grass_id = 1;
+constexpr uint32_t dirt_id = 2;
+// Multiple sprite with an anchor, placed as a decoration
+constexpr uint32_t decoration_id = 9;
+constexpr double z_index_increment = 0.02;
+const Vector3i chunk_size{8, 8, 6};
+
+// Tiles of the world spritesheet loaded without a GPU, as the render system builds them
+struct Tileset
+{
+  Spritesheet spritesheet{"data/textures/tileset.png", "data/textures/tileset.json"};
+  std::unordered_map<uint32_t, Tile> tiles{};
+  Vector2i tile_size{};
+
+  Tileset()
+  {
+    spritesheet.load_metadata(Vector2i{512, 512});
+    tile_size = spritesheet.get_frame_size();
+
+    for (const auto id : {grass_id, dirt_id, decoration_id})
+    {
+      const auto& frame_data = spritesheet.id_to_frame(id, frame_data_type::tile);
+      const auto& frame_size = spritesheet.get_frame_size();
+      glm::vec2 size{frame_size.x * frame_data.width, frame_size.y * frame_data.height};
+      tiles.insert({id, Tile{&spritesheet, &frame_data, std::move(size)}});
+    }
+  }
+};
+
+std::unique_ptr<Chunk> create_chunk()
+{
+  auto chunk = std::make_unique<Chunk>(Vector3i{32, 64, 0}, true);
+  chunk->tiles.set_size(chunk_size);
+
+  for (int y = 0; y < chunk_size.y; ++y)
+  {
+    for (int x = 0; x < chunk_size.x; ++x)
+    {
+      // Uneven terrain with holes so that some cells have a visible front face
+      const int height = (x * 3 + y) % chunk_size.z;
+
+      for (int z = 0; z <= height; ++z)
+      {
+        if (z == 1 && x % 3 == 0)
+        {
+          continue;
+        }
+
+        auto& cell = chunk->tiles.values[x + y * chunk_size.x + z * chunk_size.x * chunk_size.y];
+        cell.top_face = grass_id;
+        cell.front_face = dirt_id;
+        cell.top_face_decoration = z == height && (x * y) % 3 == 0 ? decoration_id : 0;
+        cell.block_type = BlockType::Grass;
+      }
+    }
+  }
+
+  chunk->tiles.compute_visibility();
+
+  return chunk;
+}
+
+void add_tile(ChunkMesh& mesh,
+              const Tileset& tileset,
+              const uint32_t tile_id,
+              const Vector3i& world_position,
+              const int z_index = 0)
+{
+  if (tile_id <= 0)
+  {
+    return;
+  }
+
+  const auto& tile = tileset.tiles.at(tile_id);
+  const auto& tile_size = tileset.tile_size;
+
+  if (tile.frame_data->sprite_type == SpriteType::Single)
+  {
+    Batch::tile(mesh,
+                tile,
+                world_position.x * tile_size.x,
+                world_position.y * tile_size.y + z_index * z_index_increment,
+                world_position.z * tile_size.y + z_index * z_index_increment,
+                tile.frame_data->default_face);
+  }
+  else
+  {
+    Batch::tile(mesh,
+                tile,
+                (world_position.x - tile.frame_data->anchor_x) * tile_size.x,
+                (world_position.y - tile.frame_data->anchor_y) * tile_size.y,
+                world_position.z * tile_size.y + z_index * z_index_increment,
+                tile.frame_data->default_face);
+  }
+}
+
+// Quads of a column as they were added to the batch every frame before the meshes, by
+// checking the flags of every cell from the height of the column down
+ChunkMesh get_frame_quads(const Chunk& chunk, const Tileset& tileset, const int local_i, const int local_j)
+{
+  ChunkMesh mesh{};
+  const auto& tiles = chunk.tiles;
+  const auto height = tiles.height_map[local_i + local_j * tiles.size.x];
+
+  for (int z = height; z >= 0; --z)
+  {
+    if (!tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, local_i, local_j, z)
+        && !tiles.has_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, local_i, local_j, z))
+    {
+      continue;
+    }
+
+    const auto& cell = tiles.cell_at(local_i, local_j, z);
+    const Vector3i world_position = chunk.position + Vector3i{local_i, local_j, z};
+
+    if (tiles.has_flags(DL_CELL_FLAG_TOP_FACE_VISIBLE, local_i, local_j, z))
+    {
+      add_tile(mesh, tileset, cell.top_face, world_position);
+      add_tile(mesh, tileset, cell.top_face_decoration, world_position, 1);
+    }
+    if (tiles.has_flags(DL_CELL_FLAG_FRONT_FACE_VISIBLE, local_i, local_j, z))
+    {
+      add_tile(mesh, tileset, cell.front_face, world_position);
+      add_tile(mesh, tileset, cell.front_face_decoration, world_position, 1);
+    }
+  }
+
+  return mesh;
+}
+
+bool is_same_quad(const QuadData& lhs, const QuadData& rhs)
+{
+  return lhs.position == rhs.position && lhs.size == rhs.size && lhs.texture_coordinates == rhs.texture_coordinates
+         && lhs.color == rhs.color && lhs.texture_id == rhs.texture_id && lhs.face == rhs.face;
+}
+
+// Compares each column of the mesh with the quads of the same column added every frame
+bool is_same_as_frame_quads(const ChunkMesh& mesh, const Chunk& chunk, const Tileset& tileset)
+{
+  const auto& size = chunk.tiles.size;
+
+  if (mesh.revision != chunk.revision || mesh.width != size.x
+      || mesh.column_offsets.size() != static_cast<std::size_t>(size.x * size.y + 1)
+      || mesh.column_offsets.front() != 0 || mesh.column_offsets.back() != mesh.quads.size())
+  {
+    return false;
+  }
+
+  for (int local_j = 0; local_j < size.y; ++local_j)
+  {
+    for (int local_i = 0; local_i < size.x; ++local_i)
+    {
+      const auto frame_quads = get_frame_quads(chunk, tileset, local_i, local_j);
+      const auto begin = mesh.column_begin(local_i, local_j);
+      const auto end = mesh.column_end(local_i, local_j);
+
+      if (begin > end || end - begin != frame_quads.quads.size())
+      {
+        return false;
+      }
+
+      for (uint32_t i = begin; i < end; ++i)
+      {
+        if (!is_same_quad(mesh.quads[i], frame_quads.quads[i - begin]))
+        {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+uint32_t count_visible_faces(const Chunk& chunk)
+{
+  const auto& size = chunk.tiles.size;
+  uint32_t face_count = 0;
+
+  for (std::size_t i = 0; i < static_cast<std::size_t>(size.x * size.y * size.z); ++i)
+  {
+    const auto& cell = chunk.tiles.cell_at_index(i);
+
+    if (cell.flags & DL_CELL_FLAG_TOP_FACE_VISIBLE)
+    {
+      face_count += cell.top_face_decoration != 0 ? 2 : 1;
+    }
+    if (cell.flags & DL_CELL_FLAG_FRONT_FACE_VISIBLE)
+    {
+      ++face_count;
+    }
+  }
+
+  return face_count;
+}
+}  // namespace
+
+DL_TEST(chunk_mesh_matches_frame_quads)
+{
+  const Tileset tileset{};
+  const auto chunk = create_chunk();
+  const ChunkMesher chunk_mesher{tileset.tiles, tileset.tile_size, z_index_increment};
+
+  const auto mesh = chunk_mesher.build(*chunk);
+
+  DL_CHECK(mesh != nullptr);
+  DL_CHECK(!mesh->quads.empty());
+  DL_CHECK(mesh->quads.size() == count_visible_faces(*chunk));
+  DL_CHECK(is_same_as_frame_quads(*mesh, *chunk, tileset));
+
+  // Single tiles are inside of the chunk, in pixels
+  const Vector2i chunk_begin{chunk->position.x * tileset.tile_size.x, chunk->position.y * tileset.tile_size.y};
+  const Vector2i chunk_end{(chunk->position.x + chunk_size.x) * tileset.tile_size.x,
+                           (chunk->position.y + chunk_size.y) * tileset.tile_size.y};
+
+  for (const auto& quad : mesh->quads)
+  {
+    if (quad.size.x == tileset.tile_size.x && quad.size.y == tileset.tile_size.y)
+    {
+      DL_CHECK(quad.position.x >= chunk_begin.x && quad.position.x + quad.size.x <= chunk_end.x);
+      DL_CHECK(quad.position.y >= chunk_begin.y && quad.position.y + quad.size.y <= chunk_end.y);
+    }
+  }
+}
+
+DL_TEST(chunk_mesh_of_compact_tiles_matches_frame_quads)
+{
+  const Tileset tileset{};
+  const auto chunk = create_chunk();
+  const ChunkMesher chunk_mesher{tileset.tiles, tileset.tile_size, z_index_increment};
+
+  const auto dense_mesh = chunk_mesher.build(*chunk);
+  chunk->tiles.compact();
+  const auto compact_mesh = chunk_mesher.build(*chunk);
+
+  DL_CHECK(compact_mesh->quads.size() == dense_mesh->quads.size());
+  DL_CHECK(compact_mesh->column_offsets == dense_mesh->column_offsets);
+  DL_CHECK(is_same_as_frame_quads(*compact_mesh, *chunk, tileset));
+}
+
+DL_TEST(chunk_mesh_matches_frame_quads_after_edit)
+{
+  const Tileset tileset{};
+  const auto chunk = create_chunk();
+  const ChunkMesher chunk_mesher{tileset.tiles, tileset.tile_size, z_index_increment};
+
+  const auto mesh = chunk_mesher.build(*chunk);
+
+  // Replaces the top face of a column and removes its decoration, as World::set_top_face does
+  const int x = 3;
+  const int y = 3;
+  const int z = chunk->tiles.height_at(x, y);
+  chunk->tiles.set(dirt_id, x, y, z);
+  chunk->tiles.set_top_face_decoration(0, x, y, z);
+  chunk->mark_modified();
+
+  const auto edited_mesh = chunk_mesher.build(*chunk);
+
+  DL_CHECK(edited_mesh->revision != mesh->revision);
+  DL_CHECK(edited_mesh->quads.size() == mesh->quads.size() - 1);
+  DL_CHECK(edited_mesh->quads.size() == count_visible_faces(*chunk));
+  DL_CHECK(is_same_as_frame_quads(*edited_mesh, *chunk, tileset));
+}
@@ -0,0 +1,64 @@
+// Runs the registered tests, or only the ones whose name contains the first argument.
+// Run it from the repository root so that the data directory is found.
+//
+// Usage: ysamba_tests [FILTER]
+
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+#include <string_view>
+
+#include "./test.hpp"
+
+namespace
+{
+int failure_count = 0;
+}  // namespace
+
+namespace dl::test
+{
+std::vector<TestCase>& get_test_cases()
+{
+  static std::vector<TestCase> test_cases{};
+  return test_cases;
+}
+
+void fail(const char* expression, const char* file, const int line)
+{
+  spdlog::error("{}:{}: Check failed: {}", file, line, expression);
+  ++failure_count;
+}
+}  // namespace dl::test
+
+auto main(int argc, char** argv) -> int
+{
+  const std::string_view filter = argc > 1 ? argv[1] : "";
+  int test_count = 0;
+  int failed_test_count = 0;
+
+  for (const auto& test_case : dl::test::get_test_cases())
+  {
+    if (std::string_view{test_case.name}.find(filter) == std::string_view::npos)
+    {
+      continue;
+    }
+
+    const int previous_failure_count = failure_count;
+    test_case.function();
+    ++test_count;
+
+    if (failure_count > previous_failure_count)
+    {
+      spdlog::error("FAILED {}", test_case.name);
+      ++failed_test_count;
+    }
+    else
+    {
+      spdlog::info("PASSED {}", test_case.name);
+    }
+  }
+
+  spdlog::info("{} of {} tests passed", test_count - failed_test_count, test_count);
+
+  return failed_test_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "./test.hpp"
+#include "graphics/renderer/quad_data.hpp"
+
+using namespace dl;
+
+// Offsets and sizes of the vertex attributes of the main and UI render passes
+static_assert(offsetof(QuadData, position) == 0 && sizeof(QuadData::position) == 12, "Float32x3 at location 0");
+static_assert(offsetof(QuadData, size) == 12 && sizeof(QuadData::size) == 8, "Float32x2 at location 1");
+static_assert(offsetof(QuadData, texture_coordinates) == 20 && sizeof(QuadData::texture_coordinates) == 8,
+              "Unorm16x4 at location 2");
+static_assert(offsetof(QuadData, color) == 28 && sizeof(QuadData::color) == 4, "Unorm8x4 at location 3");
+// Uint8x4 at location 4, the shader reads the texture slot from x and the face from y
+static_assert(offsetof(QuadData, texture_id) == 32, "Uint8x4 at location 4");
+static_assert(offsetof(QuadData, face) == 33);
+static_assert(offsetof(QuadData, padding) + sizeof(QuadData::padding) == sizeof(QuadData));
+
+namespace
+{
+const std::array<glm::vec2, 4> uv_coordinates{
+    glm::vec2{0.25f, 0.5f}, glm::vec2{0.375f, 0.5f}, glm::vec2{0.375f, 0.625f}, glm::vec2{0.25f, 0.625f}};
+}  // namespace
+
+DL_TEST(encode_texture_coordinate_rounds_to_nearest)
+{
+  DL_CHECK(encode_texture_coordinate(0.0f) == 0);
+  DL_CHECK(encode_texture_coordinate(1.0f) == 65535);
+  DL_CHECK(encode_texture_coordinate(0.5f) == 32768);
+  DL_CHECK(encode_texture_coordinate(0.4f / 65535.0f) == 0);
+  DL_CHECK(encode_texture_coordinate(0.6f / 65535.0f) == 1);
+
+  // Frame edges of a 512 pixel atlas come back within a step
+  for (int pixel = 0; pixel <= 512; ++pixel)
+  {
+    const float value = pixel / 512.0f;
+    DL_CHECK(std::abs(decode_texture_coordinate(encode_texture_coordinate(value)) - value) <= 1.0f / 65535.0f);
+  }
+}
+
+DL_TEST(encode_texture_coordinate_clamps)
+{
+  DL_CHECK(encode_texture_coordinate(-0.1f) == 0);
+  DL_CHECK(encode_texture_coordinate(-100.0f) == 0);
+  DL_CHECK(encode_texture_coordinate(1.5f) == 65535);
+  DL_CHECK(encode_texture_coordinate(100.0f) == 65535);
+}
+
+DL_TEST(encode_texture_id_maps_negative_indices_to_no_texture)
+{
+  DL_CHECK(encode_texture_id(-1.0f) == no_texture_id);
+  DL_CHECK(no_texture_id == 255);
+  DL_CHECK(encode_texture_id(0.0f) == 0);
+  DL_CHECK(encode_texture_id(7.0f) == 7);
+}
+
+DL_TEST(encode_quad_keeps_top_left_and_bottom_right)
+{
+  const auto quad = encode_quad(
+      glm::vec3{16.0f, 32.0f, 48.5f}, glm::vec2{32.0f, 64.0f}, uv_coordinates, 3.0f, 0x11223344, DL_RENDER_FACE_FRONT);
+
+  DL_CHECK(quad.position.x == 16.0f && quad.position.y == 32.0f && quad.position.z == 48.5f);
+  DL_CHECK(quad.size.x == 32.0f && quad.size.y == 64.0f);
+  DL_CHECK(quad.texture_coordinates[0] == encode_texture_coordinate(0.25f));
+  DL_CHECK(quad.texture_coordinates[1] == encode_texture_coordinate(0.5f));
+  DL_CHECK(quad.texture_coordinates[2] == encode_texture_coordinate(0.375f));
+  DL_CHECK(quad.texture_coordinates[3] == encode_texture_coordinate(0.625f));
+  DL_CHECK(quad.color == 0x11223344);
+  DL_CHECK(quad.texture_id == 3);
+  DL_CHECK(quad.face == DL_RENDER_FACE_FRONT);
+  DL_CHECK(quad.padding == 0);
+}
+
+DL_TEST(encode_quad_of_colored_quad)
+{
+  const std::array<glm::vec2, 4> no_uv_coordinates{};
+  const auto quad = encode_quad(glm::vec3{}, glm::vec2{8.0f, 8.0f}, no_uv_coordinates, -1.0f, 0xFF0000FF);
+
+  DL_CHECK(quad.texture_id == no_texture_id);
+  DL_CHECK(quad.face == DL_RENDER_FACE_TOP);
+  DL_CHECK(quad.texture_coordinates == (std::array<uint16_t, 4>{0, 0, 0, 0}));
+}
@@ -0,0 +1,150 @@
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "./test.hpp"
+#include "constants.hpp"
+#include "core/serialization.hpp"
+#include "core/timer.hpp"
+#include "world/chunk.hpp"
+
+using namespace dl;
+
+namespace
+{
+const std::string world_id = "serialization_test";
+constexpr int region_width = 4;
+constexpr int region_height = 4;
+
+// Terrain with a varying height, some decorations and a few underground blocks, the
+// same kind of content as the generated chunks
+std::unique_ptr<Chunk> create_chunk(const Vector3i& position)
+{
+  auto chunk = std::make_unique<Chunk>(position, true);
+  chunk->tiles.set_size(world::chunk_size);
+
+  for (int y = 0; y < world::chunk_size.y; ++y)
+  {
+    for (int x = 0; x < world::chunk_size.x; ++x)
+    {
+      const int height = 10 + (x * 7 + y * 3 + position.x) % 13;
+
+      for (int z = 0; z <= height; ++z)
+      {
+        auto& cell = chunk->tiles.values[x + y * world::chunk_size.x + z * world::chunk_size.x * world::chunk_size.y];
+        cell.top_face = z == height ? 2 + x % 3 : 1;
+        cell.front_face = 1;
+        cell.top_face_decoration = z == height && (x + y) % 5 == 0 ? 77 : 0;
+        cell.block_type = z < 4 && (x * y) % 7 == 0 ? BlockType::Basalt : BlockType::Grass;
+      }
+    }
+  }
+
+  chunk->tiles.compute_visibility();
+
+  return chunk;
+}
+
+bool is_same_chunk(const Chunk& lhs, const Chunk& rhs)
+{
+  if (lhs.tiles.size != rhs.tiles.size || lhs.tiles.height_map != rhs.tiles.height_map)
+  {
+    return false;
+  }
+
+  const std::size_t cell_count = lhs.tiles.size.x * lhs.tiles.size.y * lhs.tiles.size.z;
+
+  for (std::size_t i = 0; i < cell_count; ++i)
+  {
+    const auto& a = lhs.tiles.cell_at_index(i);
+    const auto& b = rhs.tiles.cell_at_index(i);
+
+    if (a.top_face != b.top_face || a.front_face != b.front_face || a.top_face_decoration != b.top_face_decoration
+        || a.front_face_decoration != b.front_face_decoration || a.flags != b.flags || a.block_type != b.block_type)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::uintmax_t get_directory_size(const std::filesystem::path& path)
+{
+  std::uintmax_t size = 0;
+
+  for (const auto& entry : std::filesystem::recursive_directory_iterator{path})
+  {
+    if (entry.is_regular_file())
+    {
+      size += entry.file_size();
+    }
+  }
+
+  return size;
+}
+}  // namespace
+
+DL_TEST(chunk_serialization_round_trip_benchmark)
+{
+  const auto world_directory = directory::worlds / world_id;
+  std::error_code error_code{};
+  std::filesystem::remove_all(world_directory, error_code);
+
+  std::vector<std::unique_ptr<Chunk>> chunks{};
+  std::vector<const Chunk*> chunks_to_save{};
+
+  for (int j = 0; j < region_height; ++j)
+  {
+    for (int i = 0; i < region_width; ++i)
+    {
+      chunks.push_back(create_chunk(Vector3i{i * world::chunk_size.x, j * world::chunk_size.y, 0}));
+      chunks_to_save.push_back(chunks.back().get());
+    }
+  }
+
+  Timer timer{};
+  timer.start();
+  serialization::save_game_chunks(chunks_to_save, world_id);
+  timer.stop();
+
+  const auto save_time = timer.count<std::chrono::microseconds>();
+  const auto bytes_on_disk = get_directory_size(world_directory);
+
+  std::size_t load_time = 0;
+
+  for (const auto& chunk : chunks)
+  {
+    DL_CHECK(serialization::chunk_exists(chunk->position, world_id));
+
+    Chunk loaded_chunk{chunk->position, true};
+    loaded_chunk.tiles.set_size(world::chunk_size);
+
+    timer.start();
+    serialization::load_game_chunk(loaded_chunk, world_id);
+    timer.stop();
+    load_time += timer.count<std::chrono::microseconds>();
+
+    DL_CHECK(is_same_chunk(*chunk, loaded_chunk));
+  }
+
+  const auto chunk_count = chunks.size();
+
+  DL_CHECK(bytes_on_disk > 0);
+  DL_CHECK(bytes_on_disk < chunk_count * chunks.front()->tiles.get_memory_usage());
+
+  spdlog::info("Chunk serialization: {} bytes on disk per chunk, {} bytes in memory",
+               bytes_on_disk / chunk_count,
+               chunks.front()->tiles.get_memory_usage());
+  spdlog::info("Chunk serialization: saved {} chunks in {} us, loaded in {:.1f} us per chunk",
+               chunk_count,
+               save_time,
+               load_time / static_cast<double>(chunk_count));
+
+  std::filesystem::remove_all(world_directory, error_code);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Minimal test runner. Tests are registered with DL_TEST and run by tests/main.cpp,
+// DL_CHECK records a failure and lets the test continue.
+namespace dl::test
+{
+struct TestCase
+{
+  const char* name;
+  void (*function)();
+};
+
+std::vector<TestCase>& get_test_cases();
+void fail(const char* expression, const char* file, const int line);
+
+struct Registrar
+{
+  Registrar(const char* name, void (*function)()) { get_test_cases().push_back({name, function}); }
+};
+}  // namespace dl::test
+
+#define DL_TEST(name)                                              \
+  static void name();                                              \
+  static const dl::test::Registrar name##_registrar{#name, &name}; \
+  static void name()
+
+#define DL_CHECK(expression)                           \
+  do                                                   \
+  {                                                    \
+    if (!(expression))                                 \
+    {                                                  \
+      dl::test::fail(#expression, __FILE__, __LINE__); \
+    }                                                  \
+  } while (false)
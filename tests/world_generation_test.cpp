@@ -0,0 +1,177 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "./test.hpp"
+#include "config.hpp"
+#include "constants.hpp"
+#include "core/maths/random.hpp"
+#include "world/chunk.hpp"
+#include "world/generators/chunk_generator.hpp"
+#include "world/generators/island_generator.hpp"
+#include "world/generators/tile_procedure_manager.hpp"
+#include "world/metadata.hpp"
+
+using namespace dl;
+
+namespace
+{
+constexpr int seed = 7;
+constexpr int region_width = 3;
+constexpr int region_height = 3;
+constexpr int thread_count = 4;
+
+WorldMetadata generate_world_metadata()
+{
+  const Vector3i world_size{static_cast<int>(config::world_creation::world_width),
+                            static_cast<int>(config::world_creation::world_height),
+                            static_cast<int>(config::world_creation::world_depth)};
+
+  auto island_generator = IslandGenerator(world_size);
+  island_generator.generate(seed);
+
+  return WorldMetadata{
+      .seed = seed,
+      .world_size = world_size,
+      .biome_map = std::move(island_generator.biome_map),
+      .height_map = std::move(island_generator.height_map),
+      .sea_distance_field = std::move(island_generator.sea_distance_field),
+  };
+}
+
+Vector3i get_chunk_position(const WorldMetadata& metadata, const int index)
+{
+  // Chunks around the center of the island, where there is land and vegetation
+  const int x = metadata.world_size.x * world::map_to_tiles / 2 / world::chunk_size.x;
+  const int y = metadata.world_size.y * world::map_to_tiles / 2 / world::chunk_size.y;
+
+  return Vector3i{(x + index % region_width) * world::chunk_size.x,
+                  (y + index / region_width) * world::chunk_size.y,
+                  0};
+}
+
+std::unique_ptr<Chunk> generate_chunk(const WorldMetadata& metadata, const Vector3i& position)
+{
+  ChunkGenerator generator{metadata};
+  generator.set_size(world::chunk_size);
+  generator.generate(metadata.seed, position);
+  return std::move(generator.chunk);
+}
+
+bool is_same_cell(const Cell& lhs, const Cell& rhs)
+{
+  return lhs.top_face == rhs.top_face && lhs.front_face == rhs.front_face
+         && lhs.top_face_decoration == rhs.top_face_decoration
+         && lhs.front_face_decoration == rhs.front_face_decoration && lhs.flags == rhs.flags
+         && lhs.block_type == rhs.block_type;
+}
+
+bool is_same_chunk(const Chunk& lhs, const Chunk& rhs)
+{
+  if (lhs.position != rhs.position || lhs.tiles.size != rhs.tiles.size
+      || lhs.tiles.height_map != rhs.tiles.height_map)
+  {
+    return false;
+  }
+
+  const std::size_t cell_count = lhs.tiles.size.x * lhs.tiles.size.y * lhs.tiles.size.z;
+
+  for (std::size_t i = 0; i < cell_count; ++i)
+  {
+    if (!is_same_cell(lhs.tiles.cell_at_index(i), rhs.tiles.cell_at_index(i)))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+}  // namespace
+
+DL_TEST(random_scoped_seed_repeats_stream)
+{
+  std::vector<uint64_t> values{};
+
+  {
+    const random::ScopedSeed scoped_seed{random::make_key(seed, Vector3i{64, 128, 0})};
+
+    for (int i = 0; i < 16; ++i)
+    {
+      values.push_back(random::rng());
+    }
+  }
+
+  // Same values on another thread, regardless of what it drew before
+  std::thread thread{[&values] {
+    random::get_integer(0, 100);
+
+    const random::ScopedSeed scoped_seed{random::make_key(seed, Vector3i{64, 128, 0})};
+
+    for (const auto value : values)
+    {
+      DL_CHECK(random::rng() == value);
+    }
+  }};
+
+  thread.join();
+}
+
+DL_TEST(random_scoped_seed_restores_stream)
+{
+  const auto engine = random::rng;
+
+  {
+    const random::ScopedSeed scoped_seed{random::make_key(seed)};
+    random::rng();
+  }
+
+  auto expected_engine = engine;
+  DL_CHECK(random::rng() == expected_engine());
+}
+
+DL_TEST(chunk_generation_is_deterministic_across_threads)
+{
+  config::load();
+  // Not thread safe, initialized before the workers use it
+  TileProcedureManager::init();
+
+  const auto metadata = generate_world_metadata();
+  const int chunk_count = region_width * region_height;
+
+  std::vector<std::unique_ptr<Chunk>> serial_chunks{};
+
+  for (int i = 0; i < chunk_count; ++i)
+  {
+    serial_chunks.push_back(generate_chunk(metadata, get_chunk_position(metadata, i)));
+  }
+
+  // Each thread generates every thread_count-th chunk in reverse order, so the chunks are
+  // generated in a different order and on different threads than in the serial pass
+  std::vector<std::unique_ptr<Chunk>> parallel_chunks(chunk_count);
+  std::vector<std::thread> threads{};
+
+  for (int t = 0; t < thread_count; ++t)
+  {
+    threads.emplace_back([&metadata, &parallel_chunks, chunk_count, t] {
+      for (int i = chunk_count - 1 - t; i >= 0; i -= thread_count)
+      {
+        parallel_chunks[i] = generate_chunk(metadata, get_chunk_position(metadata, i));
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (int i = 0; i < chunk_count; ++i)
+  {
+    DL_CHECK(parallel_chunks[i] != nullptr);
+    DL_CHECK(is_same_chunk(*serial_chunks[i], *parallel_chunks[i]));
+  }
+
+  // A chunk generated again on the same thread after other chunks is also the same
+  const auto regenerated_chunk = generate_chunk(metadata, get_chunk_position(metadata, 0));
+  DL_CHECK(is_same_chunk(*serial_chunks[0], *regenerated_chunk));
+}
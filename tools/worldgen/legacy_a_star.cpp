@@ -0,0 +1,169 @@
+#include "./legacy_a_star.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/maths/neighbor_iterator.hpp"
+#include "world/a_star.hpp"
+
+namespace
+{
+// Octile distance weighted in the same way as AStar
+int distance(const dl::Vector3i& a, const dl::Vector3i& b)
+{
+  constexpr float scale = 1.2f;
+  constexpr int normal_cost = 100 * scale;
+  constexpr int diagonal_cost = 141 * scale;
+
+  const int dx = std::abs(a.x - b.x);
+  const int dy = std::abs(a.y - b.y);
+  return normal_cost * (dx + dy) + (diagonal_cost - 2 * normal_cost) * std::min(dx, dy);
+}
+
+bool node_compare(const dl::LegacyAStar::Node& a, const dl::LegacyAStar::Node& b)
+{
+  return a.f > b.f || (a.f == b.f && a.h > b.h);
+}
+}  // namespace
+
+namespace dl
+{
+LegacyAStar::LegacyAStar(WalkableFunction is_walkable,
+                         const Vector3i& origin,
+                         const Vector3i& destination,
+                         const std::size_t max_steps)
+    : origin(origin), destination(destination), max_steps(max_steps), m_is_walkable(std::move(is_walkable))
+{
+  if (origin == destination)
+  {
+    state = State::SUCCEEDED;
+    return;
+  }
+
+  if (!m_is_walkable(destination.x, destination.y, destination.z))
+  {
+    state = State::FAILED;
+    return;
+  }
+
+  m_open_set.push_back(Node{origin, nullptr, 0, 0, 0});
+  state = State::INITIALIZED;
+}
+
+void LegacyAStar::step()
+{
+  if (state == State::NONE)
+  {
+    return;
+  }
+
+  if (state == State::INITIALIZED)
+  {
+    state = State::SEARCHING;
+  }
+
+  if (state != State::SEARCHING)
+  {
+    return;
+  }
+
+  if (m_open_set.empty())
+  {
+    state = State::FAILED;
+    return;
+  }
+
+  ++steps;
+
+  if (steps > max_steps)
+  {
+    state = State::FAILED;
+    return;
+  }
+
+  auto current_node = m_open_set.front();
+
+  if (current_node.position == destination)
+  {
+    state = State::SUCCEEDED;
+    path.push_back(current_node.position);
+
+    while (current_node.parent != nullptr)
+    {
+      path.push_back(current_node.parent->position);
+      current_node = *current_node.parent;
+    }
+
+    return;
+  }
+
+  std::pop_heap(m_open_set.begin(), m_open_set.end(), node_compare);
+  m_open_set.pop_back();
+
+  m_closed_set.push_back(std::make_shared<Node>(current_node));
+
+  NeighborIterator<Vector3i> it{current_node.position};
+
+  for (; it.neighbor != 8; ++it)
+  {
+    auto neighbor = *it;
+    const int h = distance(neighbor, destination);
+    const bool walkable = m_is_walkable(neighbor.x, neighbor.y, neighbor.z);
+
+    if (!walkable && h > current_node.h)
+    {
+      continue;
+    }
+    else if (!walkable && h < current_node.h)
+    {
+      const bool can_climb_up = m_is_walkable(neighbor.x, neighbor.y, neighbor.z + 1);
+      const bool can_climb_down = m_is_walkable(neighbor.x, neighbor.y, neighbor.z - 1);
+
+      if (can_climb_up)
+      {
+        neighbor = Vector3i{neighbor.x, neighbor.y, neighbor.z + 1};
+      }
+      else if (can_climb_down)
+      {
+        neighbor = Vector3i{neighbor.x, neighbor.y, neighbor.z - 1};
+      }
+      else
+      {
+        continue;
+      }
+    }
+    else if (!walkable)
+    {
+      continue;
+    }
+
+    const auto closed_it = std::find_if(
+        m_closed_set.begin(), m_closed_set.end(), [&neighbor](const auto& node) { return node->position == neighbor; });
+
+    if (closed_it != m_closed_set.end())
+    {
+      continue;
+    }
+
+    const int g = current_node.g + AStar::get_cost(current_node.position, neighbor, it.is_diagonal);
+    const int f = g + h;
+
+    auto open_it = std::find_if(
+        m_open_set.begin(), m_open_set.end(), [&neighbor](const auto& node) { return node.position == neighbor; });
+
+    if (open_it == m_open_set.end())
+    {
+      auto& closed_node = m_closed_set[m_closed_set.size() - 1];
+
+      m_open_set.push_back(Node{neighbor, closed_node.get(), f, g, h});
+      std::push_heap(m_open_set.begin(), m_open_set.end(), node_compare);
+    }
+    else if (g < open_it->g)
+    {
+      open_it->g = g;
+      open_it->f = f;
+      open_it->parent = m_closed_set.back().get();
+    }
+  }
+}
+}  // namespace dl
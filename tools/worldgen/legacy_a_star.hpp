@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/maths/vector.hpp"
+
+namespace dl
+{
+// A* as it was before the node arena and the indexed open set, with a heap that isn't
+// updated when a node gets cheaper and a closed set searched linearly. Only kept to
+// compare the pathfinding benchmark with the current implementation.
+class LegacyAStar
+{
+ public:
+  using WalkableFunction = std::function<bool(const int, const int, const int)>;
+
+  enum class State
+  {
+    NONE,
+    INITIALIZED,
+    SEARCHING,
+    SUCCEEDED,
+    FAILED,
+  };
+
+  struct Node
+  {
+    Vector3i position;
+    Node* parent = nullptr;
+    int f = 0;
+    int g = 0;
+    int h = 0;
+  };
+
+  State state = State::NONE;
+  Vector3i origin;
+  Vector3i destination;
+  std::size_t steps = 0;
+  std::size_t max_steps = 0;
+  std::vector<Vector3i> path{};
+
+  LegacyAStar(WalkableFunction is_walkable,
+              const Vector3i& origin,
+              const Vector3i& destination,
+              const std::size_t max_steps);
+
+  void step();
+
+ private:
+  WalkableFunction m_is_walkable;
+  std::vector<Node> m_open_set{};
+  std::vector<std::shared_ptr<Node>> m_closed_set{};
+};
+}  // namespace dl
@@ -0,0 +1,333 @@
+// Generates a world without a display, used to profile the generators and to check that
+// they are deterministic. Run it from the repository root so that the data directory is found.
+//
+// Usage: ysamba_worldgen [--seed N] [--map-size WIDTH HEIGHT] [--chunks WIDTH HEIGHT] [--origin X Y] [--threads N]
+//                        [--noise-cache N] [--save] [--paths N]
+//
+// --map-size overrides the island size of the world creation config
+// --noise-cache overrides config::world::noise_cache_size, 0 disables the chunk noise cache
+// --paths N solves N random walks on the generated chunks with the current and the previous A*
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+// Included after windows.h
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "./path_benchmark.hpp"
+#include "config.hpp"
+#include "constants.hpp"
+#include "core/serialization.hpp"
+#include "core/timer.hpp"
+#include "core/utils.hpp"
+#include "world/chunk.hpp"
+#include "world/chunk_manager.hpp"
+#include "world/generators/chunk_generator.hpp"
+#include "world/generators/island_generator.hpp"
+#include "world/generators/tile_procedure_manager.hpp"
+#include "world/metadata.hpp"
+
+namespace
+{
+struct Options
+{
+  int seed = 1;
+  // Defaults to the size in the world creation config
+  dl::Vector2i map_size{-1, -1};
+  dl::Vector2i chunks{4, 4};
+  // Defaults to the center of the map
+  dl::Vector2i origin{-1, -1};
+  int thread_count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  // Defaults to the size in the config
+  int noise_cache_size = -1;
+  bool save = false;
+  int path_count = 0;
+};
+
+bool parse_options(const int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string_view argument{argv[i]};
+    const int remaining = argc - i - 1;
+
+    if (argument == "--seed" && remaining >= 1)
+    {
+      options.seed = std::atoi(argv[++i]);
+    }
+    else if (argument == "--map-size" && remaining >= 2)
+    {
+      options.map_size.x = std::atoi(argv[++i]);
+      options.map_size.y = std::atoi(argv[++i]);
+    }
+    else if (argument == "--chunks" && remaining >= 2)
+    {
+      options.chunks.x = std::atoi(argv[++i]);
+      options.chunks.y = std::atoi(argv[++i]);
+    }
+    else if (argument == "--origin" && remaining >= 2)
+    {
+      options.origin.x = std::atoi(argv[++i]);
+      options.origin.y = std::atoi(argv[++i]);
+    }
+    else if (argument == "--threads" && remaining >= 1)
+    {
+      options.thread_count = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (argument == "--noise-cache" && remaining >= 1)
+    {
+      options.noise_cache_size = std::max(0, std::atoi(argv[++i]));
+    }
+    else if (argument == "--save")
+    {
+      options.save = true;
+    }
+    else if (argument == "--paths" && remaining >= 1)
+    {
+      options.path_count = std::max(0, std::atoi(argv[++i]));
+    }
+    else
+    {
+      spdlog::critical("Invalid argument: {}", argument);
+      return false;
+    }
+  }
+
+  const bool has_valid_map_size
+      = options.map_size == dl::Vector2i{-1, -1} || (options.map_size.x > 0 && options.map_size.y > 0);
+
+  return options.chunks.x > 0 && options.chunks.y > 0 && has_valid_map_size;
+}
+
+// FNV-1a
+void hash_bytes(uint64_t& hash, const void* data, const std::size_t size)
+{
+  const auto* bytes = static_cast<const uint8_t*>(data);
+
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3;
+  }
+}
+
+template <typename T>
+void hash_value(uint64_t& hash, const T& value)
+{
+  hash_bytes(hash, &value, sizeof(T));
+}
+
+uint64_t hash_chunk(const dl::Chunk& chunk)
+{
+  uint64_t hash = 0xcbf29ce484222325;
+  const auto& tiles = chunk.tiles;
+  const std::size_t cell_count = tiles.size.x * tiles.size.y * tiles.size.z;
+
+  for (std::size_t i = 0; i < cell_count; ++i)
+  {
+    const auto& cell = tiles.cell_at_index(i);
+    hash_value(hash, cell.top_face);
+    hash_value(hash, cell.front_face);
+    hash_value(hash, cell.top_face_decoration);
+    hash_value(hash, cell.front_face_decoration);
+    hash_value(hash, cell.flags);
+    hash_value(hash, cell.block_type);
+  }
+
+  hash_bytes(hash, tiles.height_map.data(), tiles.height_map.size() * sizeof(int));
+  return hash;
+}
+
+// Peak resident set size in bytes
+std::size_t get_peak_rss()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters{};
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize;
+#else
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+}  // namespace
+
+auto main(int argc, char** argv) -> int
+{
+  using namespace dl;
+
+  spdlog::set_level(spdlog::level::info);
+
+  Options options{};
+
+  if (!parse_options(argc, argv, options))
+  {
+    spdlog::info("Usage: {} [--seed N] [--map-size WIDTH HEIGHT] [--chunks WIDTH HEIGHT] [--origin X Y] [--threads N] "
+                 "[--noise-cache N] [--save] [--paths N]",
+                 argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  config::load();
+
+  if (options.map_size != Vector2i{-1, -1})
+  {
+    config::world_creation::world_width = options.map_size.x;
+    config::world_creation::world_height = options.map_size.y;
+  }
+
+  // Read by the chunk generators when the first chunk is generated
+  if (options.noise_cache_size >= 0)
+  {
+    config::world::noise_cache_size = options.noise_cache_size;
+  }
+
+  // Initialized before the workers start since it isn't thread safe
+  TileProcedureManager::init();
+
+  const Vector3i world_size{static_cast<int>(config::world_creation::world_width),
+                            static_cast<int>(config::world_creation::world_height),
+                            static_cast<int>(config::world_creation::world_depth)};
+
+  // Island
+  Timer timer{};
+  timer.start();
+
+  auto island_generator = IslandGenerator(world_size);
+  island_generator.generate(options.seed);
+
+  timer.stop();
+  const auto island_time = timer.count<std::chrono::milliseconds>();
+
+  const auto now = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+
+  WorldMetadata metadata{
+      .id = utils::generate_id(),
+      .name = "worldgen",
+      .seed = options.seed,
+      .world_size = world_size,
+      .initial_position = Vector2i{world_size.x / 2, world_size.y / 2},
+      .created_at = now,
+      .updated_at = now,
+      .biome_map = std::move(island_generator.biome_map),
+      .height_map = std::move(island_generator.height_map),
+      .sea_distance_field = std::move(island_generator.sea_distance_field),
+  };
+
+  uint64_t island_hash = 0xcbf29ce484222325;
+  hash_bytes(island_hash, metadata.height_map.data(), metadata.height_map.size() * sizeof(float));
+  hash_bytes(island_hash, metadata.biome_map.data(), metadata.biome_map.size() * sizeof(BiomeType));
+
+  if (options.save)
+  {
+    serialization::initialize_directories();
+    serialization::save_world_metadata(metadata);
+  }
+
+  // Chunks
+  if (options.origin == Vector2i{-1, -1})
+  {
+    options.origin = Vector2i{world_size.x * world::map_to_tiles / 2, world_size.y * world::map_to_tiles / 2};
+  }
+
+  const auto origin = ChunkManager::world_to_chunk(options.origin.x, options.origin.y, 0);
+  const int chunk_count = options.chunks.x * options.chunks.y;
+  std::vector<std::unique_ptr<Chunk>> chunks(chunk_count);
+  std::atomic<int> next_chunk = 0;
+
+  const auto generate_chunks = [&]() {
+    for (int i = next_chunk++; i < chunk_count; i = next_chunk++)
+    {
+      const Vector3i position{origin.x + (i % options.chunks.x) * world::chunk_size.x,
+                              origin.y + (i / options.chunks.x) * world::chunk_size.y,
+                              origin.z};
+
+      ChunkGenerator generator{metadata};
+      generator.set_size(world::chunk_size);
+      generator.generate(metadata.seed, position);
+      chunks[i] = std::move(generator.chunk);
+    }
+  };
+
+  timer.start();
+
+  std::vector<std::thread> threads{};
+
+  for (int i = 0; i < options.thread_count; ++i)
+  {
+    threads.emplace_back(generate_chunks);
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  timer.stop();
+  const auto chunks_time = timer.count<std::chrono::milliseconds>();
+
+  // Combined in a fixed order so that it doesn't depend on which thread generated each chunk
+  uint64_t chunks_hash = 0xcbf29ce484222325;
+
+  for (const auto& chunk : chunks)
+  {
+    hash_value(chunks_hash, hash_chunk(*chunk));
+  }
+
+  if (options.save)
+  {
+    std::vector<const Chunk*> chunks_to_save{};
+
+    for (const auto& chunk : chunks)
+    {
+      chunks_to_save.push_back(chunk.get());
+    }
+
+    serialization::save_game_chunks(chunks_to_save, metadata.id);
+    spdlog::info("Saved world {}", metadata.id);
+  }
+
+  const auto chunks_per_second = chunks_time > 0 ? chunk_count * 1000.0 / chunks_time : 0.0;
+
+  spdlog::info("Seed: {}", options.seed);
+  spdlog::info("Island: {}x{} in {} ms", world_size.x, world_size.y, island_time);
+
+  for (const auto& stage_timing : island_generator.stage_timings)
+  {
+    spdlog::info("  {}: {:.2f} ms", stage_timing.name, stage_timing.milliseconds);
+  }
+
+  spdlog::info("Chunks: {} in {} ms on {} threads ({:.2f} chunks/s, noise cache of {} chunks)",
+               chunk_count,
+               chunks_time,
+               options.thread_count,
+               chunks_per_second,
+               config::world::noise_cache_size);
+  spdlog::info("Peak RSS: {:.2f} MB", get_peak_rss() / (1024.0 * 1024.0));
+  spdlog::info("Island hash: {:016x}", island_hash);
+  spdlog::info("Chunks hash: {:016x}", chunks_hash);
+
+  if (options.path_count > 0)
+  {
+    run_path_benchmark(chunks, options.path_count, options.seed);
+  }
+
+  return EXIT_SUCCESS;
+}
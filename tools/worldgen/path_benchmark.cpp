@@ -0,0 +1,249 @@
+#include "./path_benchmark.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "./legacy_a_star.hpp"
+#include "config.hpp"
+#include "constants.hpp"
+#include "core/json.hpp"
+#include "core/timer.hpp"
+#include "world/a_star.hpp"
+#include "world/chunk.hpp"
+#include "world/chunk_manager.hpp"
+#include "world/tile_flag.hpp"
+
+namespace
+{
+// Furthest a destination can be from its origin on each axis, in tiles
+constexpr int max_walk_distance = 48;
+
+struct Query
+{
+  dl::Vector3i origin;
+  dl::Vector3i destination;
+};
+
+struct Result
+{
+  std::size_t nodes = 0;
+  int succeeded = 0;
+  std::vector<double> latencies{};
+};
+
+// Same table as World::tile_flags without loading the rest of the world data
+std::vector<uint32_t> load_tile_flags()
+{
+  dl::JSON json_tile_data{dl::config::path::tile_data};
+  std::vector<uint32_t> tile_flags{};
+
+  for (const auto& tile : json_tile_data.object["tiles"])
+  {
+    const auto id = tile["id"].get<uint32_t>();
+
+    if (id >= tile_flags.size())
+    {
+      tile_flags.resize(id + 1, dl::DL_TILE_FLAG_NONE);
+    }
+
+    if (tile.contains("flags"))
+    {
+      for (const auto& flag : tile["flags"].get<std::vector<std::string>>())
+      {
+        tile_flags[id] |= dl::tile_flag::to_bit(flag);
+      }
+    }
+  }
+
+  return tile_flags;
+}
+
+uint32_t next_random(uint32_t& state)
+{
+  state = state * 1664525u + 1013904223u;
+  return state >> 8;
+}
+
+// Picks walkable origins and destinations inside of the generated area, the destinations
+// may be unreachable or too far for max_steps as it happens in the game
+std::vector<Query> create_queries(const std::vector<std::unique_ptr<dl::Chunk>>& chunks,
+                                  const dl::AStar::WalkableFunction& is_walkable,
+                                  const int query_count,
+                                  const int seed)
+{
+  dl::Vector3i begin = chunks.front()->position;
+  dl::Vector3i end = chunks.front()->position;
+
+  for (const auto& chunk : chunks)
+  {
+    begin.x = std::min(begin.x, chunk->position.x);
+    begin.y = std::min(begin.y, chunk->position.y);
+    end.x = std::max(end.x, chunk->position.x + dl::world::chunk_size.x);
+    end.y = std::max(end.y, chunk->position.y + dl::world::chunk_size.y);
+  }
+
+  const auto get_walkable_position = [&](const int x, const int y, dl::Vector3i& position)
+  {
+    for (int z = dl::world::chunk_size.z - 1; z >= 0; --z)
+    {
+      if (is_walkable(x, y, z))
+      {
+        position = dl::Vector3i{x, y, z};
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  std::vector<Query> queries{};
+  uint32_t random_state = static_cast<uint32_t>(seed);
+
+  // Bounded so that a map without walkable tiles doesn't loop forever
+  for (int i = 0; i < query_count * 100 && static_cast<int>(queries.size()) < query_count; ++i)
+  {
+    const int x = begin.x + next_random(random_state) % (end.x - begin.x);
+    const int y = begin.y + next_random(random_state) % (end.y - begin.y);
+    const int destination_x = x + next_random(random_state) % (max_walk_distance * 2 + 1) - max_walk_distance;
+    const int destination_y = y + next_random(random_state) % (max_walk_distance * 2 + 1) - max_walk_distance;
+
+    Query query{};
+
+    if (get_walkable_position(x, y, query.origin)
+        && get_walkable_position(destination_x, destination_y, query.destination))
+    {
+      queries.push_back(query);
+    }
+  }
+
+  return queries;
+}
+
+template <typename Solve>
+Result solve_queries(const std::vector<Query>& queries, Solve solve)
+{
+  Result result{};
+  dl::Timer timer{};
+
+  for (const auto& query : queries)
+  {
+    timer.start();
+    const auto [steps, succeeded] = solve(query);
+    timer.stop();
+
+    result.nodes += steps;
+    result.succeeded += succeeded ? 1 : 0;
+    result.latencies.push_back(timer.count<std::chrono::nanoseconds>() / 1'000'000.0);
+  }
+
+  return result;
+}
+
+double get_percentile(std::vector<double> values, const double percentile)
+{
+  if (values.empty())
+  {
+    return 0.0;
+  }
+
+  std::sort(values.begin(), values.end());
+  return values[static_cast<std::size_t>(percentile * (values.size() - 1))];
+}
+
+void print_result(const char* name, const Result& result)
+{
+  double total_ms = 0.0;
+
+  for (const auto latency : result.latencies)
+  {
+    total_ms += latency;
+  }
+
+  const auto nodes_per_second = total_ms > 0.0 ? result.nodes * 1000.0 / total_ms : 0.0;
+
+  spdlog::info("{}: {:.0f} nodes/s, p50 {:.3f} ms, p99 {:.3f} ms, {} found",
+               name,
+               nodes_per_second,
+               get_percentile(result.latencies, 0.5),
+               get_percentile(result.latencies, 0.99),
+               result.succeeded);
+}
+}  // namespace
+
+namespace dl
+{
+void run_path_benchmark(const std::vector<std::unique_ptr<Chunk>>& chunks, const int query_count, const int seed)
+{
+  const auto tile_flags = load_tile_flags();
+  std::unordered_map<uint64_t, const Chunk*> chunk_index{};
+
+  for (const auto& chunk : chunks)
+  {
+    chunk->compute_walkability(tile_flags);
+    chunk_index.emplace(ChunkManager::chunk_key(chunk->position), chunk.get());
+  }
+
+  // Same lookup as World::is_walkable, positions outside of the generated chunks are blocked
+  const AStar::WalkableFunction is_walkable = [&chunk_index](const int x, const int y, const int z)
+  {
+    const auto chunk_position = ChunkManager::world_to_chunk(x, y, z);
+    const auto found = chunk_index.find(ChunkManager::chunk_key(chunk_position));
+
+    if (found == chunk_index.end())
+    {
+      return false;
+    }
+
+    const auto& position = found->second->position;
+    return found->second->is_walkable(x - position.x, y - position.y, z - position.z);
+  };
+
+  const auto queries = create_queries(chunks, is_walkable, query_count, seed);
+  const std::size_t max_steps = config::pathfinding::max_steps;
+
+  // Both implementations warn about every path that isn't found
+  const auto log_level = spdlog::get_level();
+  spdlog::set_level(spdlog::level::err);
+
+  AStar a_star{is_walkable};
+
+  const auto solve = [&](const Query& query)
+  {
+    a_star.reset(query.origin, query.destination, max_steps);
+
+    do
+    {
+      a_star.step();
+    } while (a_star.state == AStar::State::SEARCHING);
+
+    return std::pair{a_star.steps, a_star.state == AStar::State::SUCCEEDED};
+  };
+
+  // The legacy implementation allocates its sets for every search, as AStar did before
+  const auto solve_legacy = [&](const Query& query)
+  {
+    LegacyAStar legacy_a_star{is_walkable, query.origin, query.destination, max_steps};
+
+    do
+    {
+      legacy_a_star.step();
+    } while (legacy_a_star.state == LegacyAStar::State::SEARCHING);
+
+    return std::pair{legacy_a_star.steps, legacy_a_star.state == LegacyAStar::State::SUCCEEDED};
+  };
+
+  const auto result = solve_queries(queries, solve);
+  const auto legacy_result = solve_queries(queries, solve_legacy);
+
+  spdlog::set_level(log_level);
+
+  spdlog::info("Paths: {} queries at {} max steps", queries.size(), max_steps);
+  print_result("A*", result);
+  print_result("Legacy A*", legacy_result);
+}
+}  // namespace dl
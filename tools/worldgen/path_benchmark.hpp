@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dl
+{
+struct Chunk;
+
+// Solves the same random walks on the generated chunks with AStar and LegacyAStar at
+// config::pathfinding::max_steps and prints the expanded nodes per second and the latencies
+void run_path_benchmark(const std::vector<std::unique_ptr<Chunk>>& chunks, const int query_count, const int seed);
+}  // namespace dl